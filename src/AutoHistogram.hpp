@@ -0,0 +1,170 @@
+#ifndef __NUMERIC_AUTO_HISTOGRAM_HPP__
+#define __NUMERIC_AUTO_HISTOGRAM_HPP__
+
+#include <algorithm>
+#include <stdexcept>
+#include <vector>
+#include <math.h>
+#include "Histogram.hpp"
+
+namespace numeric
+{
+
+/**
+ * @brief Histogram with a fixed number of bins which adapts its interval to
+ * the data, so no pass over the data is needed to find min and max first.
+ *
+ * The first count values are kept as they are and determine the initial
+ * interval. After that, whenever a value falls outside the interval, pairs of
+ * neighbouring bins are merged, which doubles the bin width and frees half of
+ * the bins to extend the interval above or below. This is repeated until the
+ * value fits, so the memory stays at count bins. Since the interval can only
+ * grow by doubling, in each direction, it is up to about four times as wide
+ * as the range of the values.
+ *
+ * The counts are available as a plain Histogram with the current interval.
+ * While fewer than count values were added, histogram() fixes the interval
+ * from them and counts them first, so even this const accessor modifies the
+ * object. Threads sharing an AutoHistogram need a lock around it, and
+ * around the cumulative queries of the returned Histogram.
+ *
+ * @code
+ * AutoHistogram h( 128 );
+ * for( ... ) h.update( value );
+ * double median = h.histogram().quantile( 0.5 );
+ * @endcode
+ */
+class AutoHistogram
+{
+    /** counts and current interval, only used once the buffer is flushed */
+    mutable Histogram hist_;
+    /** the first values, until there are enough for an interval estimate */
+    mutable std::vector<double> buffer_;
+    mutable bool ranged_;
+
+    /** sets the interval from the buffered values and counts them */
+    void flush() const
+    {
+	if( ranged_ || buffer_.empty() )
+	    return;
+
+	const double lo = *std::min_element( buffer_.begin(), buffer_.end() );
+	const double hi = *std::max_element( buffer_.begin(), buffer_.end() );
+	// the largest value goes into the last bin, if all values are the same
+	// use an interval relative to their magnitude
+	double width = (hi - lo) / (hist_.count - 1);
+	if( !(width > 0.0) )
+	    width = std::max( fabs( lo ), 1.0 ) / hist_.count;
+	hist_.min_val = lo;
+	hist_.max_val = lo + hist_.count * width;
+	ranged_ = true;
+
+	for( size_t i = 0; i < buffer_.size(); i++ )
+	    add( buffer_[i] );
+	buffer_.clear();
+	hist_.invalidate();
+    }
+
+    /** merges neighbouring bins into the lower half, the interval grows up */
+    void growUp() const
+    {
+	const int half = hist_.count / 2;
+	std::vector<size_t>& b( hist_.buckets );
+	for( int j = 0; j < half; j++ )
+	    b[j] = b[2*j] + b[2*j+1];
+	std::fill( b.begin() + half, b.end(), 0 );
+	hist_.max_val += hist_.max_val - hist_.min_val;
+    }
+
+    /** merges neighbouring bins into the upper half, the interval grows down */
+    void growDown() const
+    {
+	const int half = hist_.count / 2;
+	std::vector<size_t>& b( hist_.buckets );
+	for( int j = hist_.count - 1; j >= half; j-- )
+	    b[j] = b[2*(j-half)] + b[2*(j-half)+1];
+	std::fill( b.begin(), b.begin() + half, 0 );
+	hist_.min_val -= hist_.max_val - hist_.min_val;
+    }
+
+    void add( double value ) const
+    {
+	while( value >= hist_.max_val )
+	    growUp();
+	while( value < hist_.min_val )
+	    growDown();
+	++hist_.n;
+	++hist_.buckets[ hist_.getIndex( value ) ];
+    }
+
+public:
+    /**
+     * @param count - number of bins, needs to be even and at least 2
+     */
+    explicit AutoHistogram( int count )
+	: hist_( std::max( count, 1 ), 0.0, 1.0 ), ranged_( false )
+    {
+	if( count < 2 || count % 2 )
+	    throw std::invalid_argument("numeric::AutoHistogram: count needs to be even and at least 2.");
+	buffer_.reserve( count );
+    }
+
+    /**
+     * @brief counts the value, grows the interval if it falls outside
+     *
+     * @param value - needs to be finite
+     */
+    void update( double value )
+    {
+	if( !isfinite( value ) )
+	    throw std::invalid_argument("numeric::AutoHistogram: can not count non-finite values.");
+
+	if( !ranged_ )
+	{
+	    buffer_.push_back( value );
+	    if( buffer_.size() >= hist_.size() )
+		flush();
+	    return;
+	}
+	add( value );
+	hist_.invalidate();
+    }
+
+    /**
+     * @brief the counts with the current interval
+     *
+     * If fewer than count values were added, the interval is estimated from
+     * the values so far.
+     */
+    const Histogram& histogram() const
+    {
+	flush();
+	return hist_;
+    }
+
+    size_t size() const
+    {
+	return hist_.size();
+    }
+
+    /**
+     * total number of values in the bins
+     */
+    size_t total() const
+    {
+	return ranged_ ? hist_.total() : buffer_.size();
+    }
+
+    void clear()
+    {
+	std::fill( hist_.buckets.begin(), hist_.buckets.end(), 0 );
+	hist_.n = 0;
+	hist_.invalidate();
+	buffer_.clear();
+	ranged_ = false;
+    }
+};
+
+}
+
+#endif
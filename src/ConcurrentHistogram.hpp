@@ -0,0 +1,124 @@
+#ifndef __NUMERIC_CONCURRENT_HISTOGRAM_HPP__
+#define __NUMERIC_CONCURRENT_HISTOGRAM_HPP__
+
+#include <atomic>
+#include <memory>
+#include <stdint.h>
+#include "Histogram.hpp"
+#include "Parallel.hpp"
+
+namespace numeric
+{
+
+/**
+ * @brief Histogram which many threads can update concurrently without locks.
+ *
+ * The counters are striped: there is one set of atomic counters per stripe,
+ * each starting on its own cache line, and every thread records into the
+ * stripe it got assigned on first use. As long as there are at least as many
+ * stripes as recording threads, the threads never contend on a cache line.
+ * Increments are relaxed atomic operations.
+ *
+ * snapshot() sums up the stripes into a plain Histogram. Each counter is read
+ * atomically and the total of the snapshot is the sum of its buckets, so the
+ * snapshot is always consistent in itself, even while other threads are
+ * still recording.
+ *
+ * @code
+ * ConcurrentHistogram h( 100, 0.0, 1.0 );
+ * // on any thread
+ * h.update( value );
+ * // on the reader
+ * Histogram s = h.snapshot();
+ * @endcode
+ */
+class ConcurrentHistogram
+{
+    /** counters per cache line */
+    static const size_t line_size = 64 / sizeof(std::atomic<size_t>);
+
+    const BucketLayout layout_;
+    size_t stripes_;
+    /** distance between the first counters of two stripes */
+    size_t stride_;
+    std::unique_ptr< std::atomic<size_t>[] > storage_;
+    std::atomic<size_t>* counters_;
+
+    static size_t threadIndex()
+    {
+	static std::atomic<size_t> next( 0 );
+	static thread_local size_t idx = next++;
+	return idx;
+    }
+
+public:
+    /**
+     * @param count - number of divisions in the interval, needs to be greater 0
+     * @param min_val - lower bound for the interval
+     * @param max_val - upper bound for the interval, needs to be greater than
+     *			min_val
+     * @param stripes - number of counter sets, 0 uses the hardware concurrency
+     */
+    ConcurrentHistogram( int count, double min_val, double max_val, size_t stripes = 0 )
+	: layout_( count, min_val, max_val ),
+	stripes_( stripes ? stripes : defaultThreadCount() ),
+	stride_( (count + line_size - 1) / line_size * line_size ),
+	storage_( new std::atomic<size_t>[ stripes_ * stride_ + line_size ] )
+    {
+	// align the first stripe to a cache line
+	size_t offset = reinterpret_cast<uintptr_t>( storage_.get() ) / sizeof(std::atomic<size_t>) % line_size;
+	counters_ = storage_.get() + (offset ? line_size - offset : 0);
+	clear();
+    }
+
+    /**
+     * @brief resets all counters to zero
+     *
+     * Must not be called while other threads are recording.
+     */
+    void clear()
+    {
+	for( size_t i = 0; i < stripes_ * stride_; i++ )
+	    counters_[i].store( 0, std::memory_order_relaxed );
+    }
+
+    /**
+     * @brief increase the count of the bin the value fits in by one
+     *
+     * Values outside the interval are counted in the first or last bin, like
+     * Histogram::update(). Safe to call from any number of threads.
+     */
+    void update( double value )
+    {
+	std::atomic<size_t>* stripe = counters_ + threadIndex() % stripes_ * stride_;
+	stripe[ layout_.getIndex( value ) ].fetch_add( 1, std::memory_order_relaxed );
+    }
+
+    /**
+     * @brief consistent copy of the current counts as plain Histogram
+     */
+    Histogram snapshot() const
+    {
+	Histogram result( layout_.count, layout_.min_val, layout_.max_val );
+	for( size_t s = 0; s < stripes_; s++ )
+	    for( size_t i = 0; i < result.size(); i++ )
+		result[i] += counters_[ s * stride_ + i ].load( std::memory_order_relaxed );
+	for( size_t i = 0; i < result.size(); i++ )
+	    result.n += result[i];
+	return result;
+    }
+
+    size_t size() const
+    {
+	return layout_.count;
+    }
+
+    size_t stripes() const
+    {
+	return stripes_;
+    }
+};
+
+}
+
+#endif
@@ -1,5 +1,6 @@
 
 #include "DiscreteFilter.hpp"
+#include "SosFilter.hpp"
 #include <base-logging/Logging.hpp>
 
 namespace numeric {
@@ -9,9 +10,6 @@ DiscreteFilter::DiscreteFilter(double samplingTime, int numFilterElements)
 	gContinuousPole1 = -1;
 	gContinuousPole2 = -1;
 
-	gMappedPole1 = exp(gContinuousPole1*gSamplingTime);
-	gMappedPole2 = exp(gContinuousPole2*gSamplingTime);
-
 	gErrorStatus = false;
 
 	if(samplingTime > 0)
@@ -40,7 +38,12 @@ DiscreteFilter::DiscreteFilter(double samplingTime, int numFilterElements)
 		gErrorStatus = true;
 	}
 
-	gPastValues = base::MatrixXd::Zero(gNumFilterElements,2);
+	gMappedPole1 = exp(gContinuousPole1*gSamplingTime);
+	gMappedPole2 = exp(gContinuousPole2*gSamplingTime);
+	updateCoefficients();
+
+	gOutput1 = Eigen::ArrayXd::Zero(gNumFilterElements);
+	gOutput2 = Eigen::ArrayXd::Zero(gNumFilterElements);
 
 	gFilterNotSet = true;
 }
@@ -50,17 +53,18 @@ bool DiscreteFilter::calcOutput(double &filteredSignal, double &inputSignal)
 	if(gErrorStatus)
 		return false;
 
-	int numFilterElements = gPastValues.rows();
 	int numInputElements = 1;
 
 	if(gFilterNotSet)
 		printWarn();
 
-	if(numFilterElements == 1)
+	if(gNumFilterElements == 1)
 	{
-		calcFiltering(filteredSignal, inputSignal, gPastValues);
+		filteredSignal = gGain*inputSignal + gCoeff1*gOutput1[0] -
+						 gCoeff2*gOutput2[0];
 
-		updateMatrix(gPastValues, filteredSignal);
+		gOutput2[0] = gOutput1[0];
+		gOutput1[0] = filteredSignal;
 
 		return true;
 	}
@@ -76,17 +80,20 @@ bool DiscreteFilter::calcOutput(base::VectorXd &filteredSignal, base::VectorXd &
 	if(gErrorStatus)
 		return false;
 
-	int numFilterElements = gPastValues.rows();
 	int numInputElements = inputSignal.size();
 
 	if(gFilterNotSet)
 		printWarn();
 
-	if(numFilterElements == numInputElements)
+	if(gNumFilterElements == numInputElements)
 	{
-		calcFiltering(filteredSignal, inputSignal, gPastValues);
+		// y[k] overwrites y[k-2], which is not needed anymore, swapping the
+		// arrays afterwards only exchanges their data pointers
+		gOutput2 = gGain*inputSignal.array() + gCoeff1*gOutput1 -
+				   gCoeff2*gOutput2;
+		gOutput1.swap(gOutput2);
 
-		updateMatrix(gPastValues, filteredSignal);
+		filteredSignal = gOutput1.matrix();
 
 		return true;
 	}
@@ -97,6 +104,114 @@ bool DiscreteFilter::calcOutput(base::VectorXd &filteredSignal, base::VectorXd &
 	}
 }
 
+bool DiscreteFilter::process(const double *inputSignal, double *filteredSignal,
+							 size_t nSamples)
+{
+	if(gErrorStatus)
+		return false;
+
+	if(gFilterNotSet)
+		printWarn();
+
+	if(gNumFilterElements != 1)
+	{
+		printError(1);
+		return false;
+	}
+
+	// keep the state in registers for the whole block
+	double output1 = gOutput1[0];
+	double output2 = gOutput2[0];
+	for (size_t k = 0; k < nSamples; k++)
+	{
+		double output = gGain*inputSignal[k] + gCoeff1*output1 -
+						gCoeff2*output2;
+		output2 = output1;
+		output1 = output;
+		filteredSignal[k] = output;
+	}
+	gOutput1[0] = output1;
+	gOutput2[0] = output2;
+
+	return true;
+}
+
+bool DiscreteFilter::process(const base::MatrixXd &inputSignal,
+							 base::MatrixXd &filteredSignal)
+{
+	if(gErrorStatus)
+		return false;
+
+	if(gFilterNotSet)
+		printWarn();
+
+	if(gNumFilterElements != inputSignal.rows())
+	{
+		printError(inputSignal.rows());
+		return false;
+	}
+
+	// no-op if both are the same matrix
+	filteredSignal.resize(inputSignal.rows(), inputSignal.cols());
+
+	for (int k = 0; k < inputSignal.cols(); k++)
+	{
+		gOutput2 = gGain*inputSignal.col(k).array() + gCoeff1*gOutput1 -
+				   gCoeff2*gOutput2;
+		gOutput1.swap(gOutput2);
+		filteredSignal.col(k) = gOutput1.matrix();
+	}
+
+	return true;
+}
+
+bool DiscreteFilter::process(base::MatrixXd &signal)
+{
+	return process(signal, signal);
+}
+
+bool DiscreteFilter::filtfilt(base::MatrixXd &signal)
+{
+	if(gErrorStatus)
+		return false;
+
+	if(gFilterNotSet)
+		printWarn();
+
+	if(gNumFilterElements != signal.rows())
+	{
+		printError(signal.rows());
+		return false;
+	}
+
+	SosFilter filter(matchedPoleZeroLowPass(gContinuousPole1, gContinuousPole2,
+											gSamplingTime), gNumFilterElements);
+	filter.filtfilt(signal);
+
+	return true;
+}
+
+bool DiscreteFilter::filtfilt(double *signal, size_t nSamples)
+{
+	if(gErrorStatus)
+		return false;
+
+	if(gFilterNotSet)
+		printWarn();
+
+	if(gNumFilterElements != 1)
+	{
+		printError(1);
+		return false;
+	}
+
+	SosFilter filter(matchedPoleZeroLowPass(gContinuousPole1, gContinuousPole2,
+											gSamplingTime));
+	filter.filtfilt(signal, nSamples);
+
+	return true;
+}
+
 bool DiscreteFilter::setPoles(double pole1, double pole2)
 {
 	if(gErrorStatus)
@@ -119,6 +234,7 @@ bool DiscreteFilter::setPoles(double pole1, double pole2)
 
 	gMappedPole1 = exp(gContinuousPole1*gSamplingTime);
 	gMappedPole2 = exp(gContinuousPole2*gSamplingTime);
+	updateCoefficients();
 	gFilterNotSet = false;
 	return true;
 }
@@ -157,57 +273,19 @@ bool DiscreteFilter::resetFilter()
 	if(gErrorStatus)
 		return false;
 
-	gPastValues = base::MatrixXd::Zero(gPastValues.rows(), gPastValues.cols());
+	gOutput1.setZero();
+	gOutput2.setZero();
 
 	return true;
 }
 
-void DiscreteFilter::calcFiltering(double &filteredSignal, double &newSignalValue,
-								   base::MatrixXd &pastSignalValues)
-{
-	base::VectorXd vecFilteredSignal = base::VectorXd::Zero(1);
-	base::VectorXd vecNewSignalValue = base::VectorXd::Zero(1);
-
-	vecNewSignalValue[0] = newSignalValue;
-
-	calcFiltering(vecFilteredSignal, vecNewSignalValue, pastSignalValues);
-
-	filteredSignal = vecFilteredSignal[0];
-}
-
-void DiscreteFilter::calcFiltering(base::VectorXd &filteredSignal,
-								   base::VectorXd &newSignalValue,
-								   base::MatrixXd &pastSignalValues)
+void DiscreteFilter::updateCoefficients()
 {
-	for (int i = 0; i < filteredSignal.size(); i++)
-	{
-		filteredSignal[i] = (1 - (gMappedPole1 + gMappedPole2) +
-							gMappedPole1*gMappedPole2)*newSignalValue[i] +
-							(gMappedPole1+gMappedPole2)*pastSignalValues(i,1) -
-							gMappedPole1*gMappedPole2*pastSignalValues(i,0);
-	}
-}
-
-void DiscreteFilter::updateMatrix(base::MatrixXd &matrix, double &newValue)
-{
-	base::VectorXd newValues = base::VectorXd::Zero(1);
-
-	newValues[0] = newValue;
-
-	updateMatrix(gPastValues, newValues);
-}
-
-void DiscreteFilter::updateMatrix(base::MatrixXd &matrix,
-								  base::VectorXd &newValues)
-{
-	int numRows = matrix.rows();
-	int numColumns = matrix.cols();
-
-	matrix.block(0, 0, numRows, numColumns - 1) =
-	matrix.block(0, 1, numRows, numColumns - 1);
-
-	matrix.block(0, numColumns - 1, numRows, 1) =
-	newValues;
+	Biquad section = matchedPoleZeroLowPass(gContinuousPole1, gContinuousPole2,
+											gSamplingTime)[0];
+	gGain = section.b0;
+	gCoeff1 = -section.a1;
+	gCoeff2 = section.a2;
 }
 
 void DiscreteFilter::printWarn()
@@ -224,7 +302,7 @@ void DiscreteFilter::printWarn()
 
 void DiscreteFilter::printError(int numInputElements)
 {
-	int numFilterElements = gPastValues.rows();
+	int numFilterElements = gNumFilterElements;
 
 	LOG_ERROR("\n\n\x1b[31m (Library: DiscreteFilter.cpp) This filter "
 			"is supposed to receive %i elements at once,"
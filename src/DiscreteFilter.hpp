@@ -33,6 +33,9 @@ namespace numeric {
  *  must be less than zero, and basically, the smaller pole1's value the
  *  more intense is the filtering (the cutting frequency is lower).
  *
+ *  The coefficients come from matchedPoleZeroLowPass(). For higher order
+ *  filters use SosFilter, which accepts the same coefficients.
+ *
  */
 
 class DiscreteFilter {
@@ -58,6 +61,61 @@ public:
 	 */
 	bool calcOutput(base::VectorXd &filteredSignal, base::VectorXd &inputSignal);
 
+	/**
+	 * Filters a block of samples of a univariable signal. Equivalent to
+	 * calling calcOutput() for each sample, but runs the recurrence over the
+	 * whole buffer in one call.
+	 *
+	 * @param inputSignal - nSamples input values.
+	 * @param filteredSignal - Buffer for nSamples filtered values, may be the
+	 *						   same as inputSignal.
+	 * @param nSamples - Number of samples.
+	 * @result - Boolean variable to confirm that everything went fine.
+	 */
+	bool process(const double *inputSignal, double *filteredSignal, size_t nSamples);
+
+	/**
+	 * Filters a block of samples of a multivariable signal, with the channels
+	 * as rows and one sample per column. Equivalent to calling calcOutput()
+	 * for each column.
+	 *
+	 * @param inputSignal - Signal to be filtered (channels x samples).
+	 * @param filteredSignal - Filtered signal, resized if needed. May be the
+	 *						   same matrix as inputSignal.
+	 * @result - Boolean variable to confirm that everything went fine.
+	 */
+	bool process(const base::MatrixXd &inputSignal, base::MatrixXd &filteredSignal);
+
+	/**
+	 * Filters a block of samples of a multivariable signal in place.
+	 *
+	 * @param signal - Signal to be filtered (channels x samples), replaced
+	 *				   by the filtered signal.
+	 * @result - Boolean variable to confirm that everything went fine.
+	 */
+	bool process(base::MatrixXd &signal);
+
+	/**
+	 * Zero-phase filtering of a whole recorded multivariable signal, with
+	 * forward and backward pass, edge padding and steady state initial
+	 * conditions (see SosFilter::filtfilt()). The state of this filter is not
+	 * changed.
+	 *
+	 * @param signal - Signal to be filtered (channels x samples), replaced
+	 *				   by the filtered signal.
+	 * @result - Boolean variable to confirm that everything went fine.
+	 */
+	bool filtfilt(base::MatrixXd &signal);
+
+	/**
+	 * Zero-phase filtering of a whole recorded univariable signal in place.
+	 *
+	 * @param signal - nSamples values, replaced by the filtered signal.
+	 * @param nSamples - Number of samples.
+	 * @result - Boolean variable to confirm that everything went fine.
+	 */
+	bool filtfilt(double *signal, size_t nSamples);
+
 	/**
 	 * Sets the continuous filter poles.
 	 *
@@ -137,53 +195,32 @@ private:
 	bool gErrorStatus;
 
 	/**
-	 * Variable that contains the last three samples
-	 */
-	base::MatrixXd gPastValues;
-
-	/**
-	 * Status variable for warning that the filter has not been set yet
-	 */
-	bool gFilterNotSet;
-
-	/**
-	 * Calculates the filtering for a multivariable signal.
+	 * Coefficients of the difference equation, computed with
+	 * matchedPoleZeroLowPass() whenever the poles change.
 	 *
-	 * @param filteredSignal - Filtered signal.
-	 * @param newSignalvalue - New signal input's value.
-	 * @param pastSignalValues - Matrix with the past output values.
+	 *	y[k] = gGain*u[k] + gCoeff1*y[k-1] - gCoeff2*y[k-2]
 	 */
-	void calcFiltering(base::VectorXd &filteredSignal,
-					   base::VectorXd &newSignalValue,
-					   base::MatrixXd &pastSignalValues);
+	double gGain;
+	double gCoeff1;
+	double gCoeff2;
 
 	/**
-	 * Calculates the filtering for a univariable signal.
-	 *
-	 * @param filteredSignal - Filtered signal.
-	 * @param newSignalvalue - New signal input's value.
-	 * @param pastSignalValues - Matrix with the past output values.
+	 * Past outputs y[k-1] and y[k-2] of all channels, one contiguous array
+	 * per delay so the update vectorizes across channels. Allocated once in
+	 * the constructor, filtering does not allocate.
 	 */
-	void calcFiltering(double &filteredSignal, double &newSignalValue,
-					   base::MatrixXd &pastSignalValues);
+	Eigen::ArrayXd gOutput1;
+	Eigen::ArrayXd gOutput2;
 
 	/**
-	 * Updates the matrix that contains the signal's past values.
-	 * For univariable filters.
-	 *
-	 * @param newValues - New signal values to be added to the matrix
-	 * @param matrix - The matrix that contains the past values of the signal
+	 * Status variable for warning that the filter has not been set yet
 	 */
-	void updateMatrix(base::MatrixXd &matrix, double &newValue);
+	bool gFilterNotSet;
 
 	/**
-	 * Updates the matrix that contains the signal's past values.
-	 * For multivariable filters.
-	 *
-	 * @param newValues - New signal values to be added to the matrix
-	 * @param matrix - The matrix that contains the past values of the signal
+	 * Calculates the difference equation coefficients from the continuous poles.
 	 */
-	void updateMatrix(base::MatrixXd &matrix, base::VectorXd &newValues);
+	void updateCoefficients();
 
 	/**
 	 * Prints warning message telling that the filter is being used
@@ -0,0 +1,171 @@
+#ifndef __NUMERIC_EXPONENTIAL_STATS_HPP__
+#define __NUMERIC_EXPONENTIAL_STATS_HPP__
+
+#include <math.h>
+#include <stdexcept>
+#include "Stats.hpp"
+
+namespace numeric
+{
+
+/**
+ * Exponentially weighted moving mean and variance of a stream of values.
+ *
+ * Each update moves the estimates towards the new sample by the smoothing
+ * factor alpha, so that older samples decay exponentially. In contrast to
+ * Stats the state has constant size and history is never thrown away. The
+ * update is the one given in
+ *
+ * T. Finch (2009): Incremental calculation of weighted mean and variance
+ *
+ *      delta = x - mean
+ *      mean  = mean + alpha * delta
+ *      var   = (1 - alpha) * (var + alpha * delta * delta^T)
+ *
+ * The first sample initializes the mean. Without samples, mean and
+ * variance are zero.
+ */
+template <class T>
+class ExponentialStats
+{
+    typedef typename Square<T>::Type SquareType;
+
+    double alpha_;
+
+    T mean_;
+    SquareType var_;
+    size_t n_;
+
+    void init( T const& data );
+
+public:
+    /**
+     * @param alpha smoothing factor in (0, 1], the larger the faster old
+     *        samples are forgotten
+     */
+    explicit ExponentialStats( double alpha );
+
+    /**
+     * Creates an accumulator for which the weight of a sample halves after
+     * the given number of further updates, i.e. alpha = 1 - 2^(-1/half_life)
+     */
+    static ExponentialStats<T> withHalfLife( double half_life );
+
+    /**
+     * Adds a sample. A weight different from 1 counts the sample as if it
+     * was added weight times, i.e. the effective smoothing factor is
+     * 1 - (1 - alpha)^weight. This also allows to handle irregular sampling
+     * by passing the time since the last sample in units of the nominal
+     * sample period.
+     */
+    void update( T const& data, double weight = 1.0 );
+    void clear();
+
+    double alpha() const { return alpha_; }
+    T mean() const;
+    SquareType var() const;
+    T stdev() const;
+    size_t n() const;
+};
+
+template <class T>
+ExponentialStats<T>::ExponentialStats( double alpha )
+    : alpha_( alpha )
+{
+    if( !(alpha > 0.0 && alpha <= 1.0) )
+	throw std::invalid_argument("numeric::ExponentialStats: alpha needs to be in (0, 1].");
+    clear();
+}
+
+template <class T>
+ExponentialStats<T> ExponentialStats<T>::withHalfLife( double half_life )
+{
+    if( !(half_life > 0.0) )
+	throw std::invalid_argument("numeric::ExponentialStats: half life needs to be positive.");
+    return ExponentialStats<T>( 1.0 - pow( 2.0, -1.0 / half_life ) );
+}
+
+template <class T>
+void ExponentialStats<T>::clear()
+{
+    n_ = 0;
+    mean_ = Zero<T>::value();
+    var_ = Zero<SquareType>::value();
+}
+
+template <>
+inline void ExponentialStats<base::VectorXd>::clear()
+{
+    // keeps the dimension of the previous samples, if any
+    n_ = 0;
+    mean_.setZero();
+    var_.setZero();
+}
+
+template <class T>
+void ExponentialStats<T>::init( T const& data )
+{
+    mean_ = data;
+    var_ = Zero<SquareType>::value();
+}
+
+template <>
+inline void ExponentialStats<base::VectorXd>::init( base::VectorXd const& data )
+{
+    int rows = data.rows();
+
+    mean_ = data;
+    var_ = base::MatrixXd::Zero(rows,rows);
+}
+
+template <class T>
+void ExponentialStats<T>::update( T const& data, double weight )
+{
+    if( !n_ )
+    {
+	init( data );
+	n_++;
+	return;
+    }
+
+    double alpha = (weight == 1.0) ? alpha_ : 1.0 - pow( 1.0 - alpha_, weight );
+    T delta = data - mean_;
+    mean_ = mean_ + alpha * delta;
+    var_ = (1.0 - alpha) * (var_ + alpha * Square<T>::value( delta ));
+
+    n_++;
+}
+
+template <class T>
+T ExponentialStats<T>::mean() const
+{
+    return mean_;
+}
+
+template <class T>
+typename ExponentialStats<T>::SquareType ExponentialStats<T>::var() const
+{
+    return var_;
+}
+
+template <class T>
+T ExponentialStats<T>::stdev() const
+{
+    return sqrt( var() );
+}
+
+template <>
+inline base::VectorXd ExponentialStats<base::VectorXd>::stdev() const
+{
+    return var().diagonal().array().sqrt();
+}
+
+template <class T>
+size_t ExponentialStats<T>::n() const
+{
+    return n_;
+}
+
+}
+
+#endif
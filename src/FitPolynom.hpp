@@ -8,78 +8,184 @@
 #include <gsl/gsl_math.h>
 #include <gsl/gsl_min.h>
 #include <iterator>
+#include <algorithm>
 #include <stdexcept>
 #include <iostream>
 #include <gsl/gsl_poly.h>
+#include <gsl/gsl_version.h>
 
 namespace numeric
 {
-  //template for calculating a polynomial fit
+  //object for calculating polynomial fits of the same degree over and over
+  //
+  //the gsl workspaces are kept between calls and only grow when a fit
+  //needs more points than any fit before, so fitting many short windows
+  //does not allocate memory. gsl 1.x needs a multifit workspace of
+  //exactly the size of the fit, there it is reallocated whenever the
+  //number of points changes
   //
   //Parameters
   //degree  ==> number of returned parameters (order of the polynom + 1)
-  //all dereferenced values must be float compatible 
+  //max_points ==> number of points the workspaces are allocated for
+  //all dereferenced values must be double compatible
   //the result will be a vector of coefficients with the highest order at the end
-  //TODO 
-  //add parameter for number of points to prevent counting them
-  template<typename TIter1,typename TIter2,typename TResult>
-    bool fitPolynom(int degree, TIter1 start_iter_x,
-        TIter1 end_iter_x,
-        TIter2 start_iter_y,
-        TIter2 end_iter_y,
-        std::vector<TResult> &result,
-        double &chisq)
-    {
-      gsl_multifit_linear_workspace *ws;
-      gsl_matrix *cov, *X;
-      gsl_vector *y, *c;
-      result.clear();
-
-      int i, j;
+  //see QRPolyFitter in PolynomialFitting.hpp for a faster fit without gsl
+  class PolyFitter
+  {
+    public:
+      explicit PolyFitter(int degree, size_t max_points = 0) :
+        degree(degree), capacity(0), X(NULL), y(NULL), c(NULL), cov(NULL), ws(NULL)
+      {
+        if(degree <= 0)
+          throw std::invalid_argument("PolyFitter: degree must be positive");
+        c = gsl_vector_alloc(degree);
+        cov = gsl_matrix_alloc(degree, degree);
+        reserve(std::max(max_points, (size_t)degree));
+      }
 
-      //TODO get rid of this !!!
-      //we have to count the number of points first;
-      TIter1 iter = start_iter_x;
-      int number_of_points = 0;
-      while(iter != end_iter_x)
+      ~PolyFitter()
       {
-        ++iter;
-        ++number_of_points;
+        release();
+        gsl_matrix_free(cov);
+        gsl_vector_free(c);
       }
 
-      //allocate memory
-      //TODO find a solution so we do not have to allocate memory all the time
-      //Maybe use a object polyfit 
-      X = gsl_matrix_alloc(number_of_points, degree);
-      y = gsl_vector_alloc(number_of_points);
-      c = gsl_vector_alloc(degree);
-      cov = gsl_matrix_alloc(degree, degree);
+      int getDegree() const { return degree; }
+      size_t getCapacity() const { return capacity; }
 
-      for(i=0; i <number_of_points; i++) 
+      //grows the workspaces so that fits of up to number_of_points
+      //do not allocate
+      void reserve(size_t number_of_points)
       {
-        gsl_matrix_set(X, i, 0, 1.0);
-        for(j=0; j < degree; j++) {
-          gsl_matrix_set(X, i, j, pow((float)*(start_iter_x), j));
+        if(number_of_points <= capacity)
+          return;
+        release();
+        X = gsl_matrix_alloc(number_of_points, degree);
+        y = gsl_vector_alloc(number_of_points);
+        ws = gsl_multifit_linear_alloc(number_of_points, degree);
+        capacity = number_of_points;
+      }
+
+      //fits number_of_points points given by x and y
+      template<typename TIter1,typename TIter2,typename TResult>
+        bool fit(size_t number_of_points, TIter1 start_iter_x, TIter2 start_iter_y,
+            std::vector<TResult> &result, double &chisq)
+        {
+          reserve(number_of_points);
+          for(size_t i=0; i < number_of_points; ++i, ++start_iter_x, ++start_iter_y)
+            setPoint(i, *start_iter_x, *start_iter_y);
+          return solve(number_of_points, result, chisq);
         }
-        gsl_vector_set(y, i, (float)*(start_iter_y));
 
-        ++start_iter_x;
-        ++start_iter_y;
-      }
+      //fits the points in [start_iter_x, end_iter_x), the number of points
+      //is only counted for iterators which are not random access
+      template<typename TIter1,typename TIter2,typename TResult>
+        bool fit(TIter1 start_iter_x, TIter1 end_iter_x, TIter2 start_iter_y,
+            std::vector<TResult> &result, double &chisq)
+        {
+          return fit(std::distance(start_iter_x, end_iter_x), start_iter_x, start_iter_y, result, chisq);
+        }
+
+      //fits number_of_points values given by start_iter over their indices 0, 1, 2, ...
+      template<typename TIter,typename TResult>
+        bool fit(size_t number_of_points, TIter start_iter, std::vector<TResult> &result, double &chisq)
+        {
+          reserve(number_of_points);
+          for(size_t i=0; i < number_of_points; ++i, ++start_iter)
+            setPoint(i, i, *start_iter);
+          return solve(number_of_points, result, chisq);
+        }
+
+      //fits the values in [start_iter, end_iter) over their indices 0, 1, 2, ...
+      template<typename TIter,typename TResult>
+        bool fit(TIter start_iter, TIter end_iter, std::vector<TResult> &result, double &chisq)
+        {
+          return fit(std::distance(start_iter, end_iter), start_iter, result, chisq);
+        }
 
-      ws = gsl_multifit_linear_alloc(number_of_points, degree);
-      gsl_multifit_linear(X, y, c, cov, &chisq, ws);
+    private:
+      PolyFitter(const PolyFitter&);
+      PolyFitter& operator=(const PolyFitter&);
+
+      //row i of the Vandermonde matrix, the powers of x are multiplied up
+      //in double precision
+      template<typename TX,typename TY>
+        void setPoint(size_t i, const TX &x, const TY &value)
+        {
+          const double xd = x;
+          double xj = 1.0;
+          for(int j=0; j < degree; j++, xj *= xd)
+            gsl_matrix_set(X, i, j, xj);
+          gsl_vector_set(y, i, value);
+        }
+
+      //solves for the first number_of_points rows, with gsl >= 2.0 the
+      //workspace may be bigger than the current fit
+      template<typename TResult>
+        bool solve(size_t number_of_points, std::vector<TResult> &result, double &chisq)
+        {
+          result.clear();
+          if(number_of_points < (size_t)degree)
+            return false;
+#if GSL_MAJOR_VERSION < 2
+          if(ws->n != number_of_points)
+          {
+            gsl_multifit_linear_free(ws);
+            ws = gsl_multifit_linear_alloc(number_of_points, degree);
+          }
+#endif
+          gsl_matrix_view X_view = gsl_matrix_submatrix(X, 0, 0, number_of_points, degree);
+          gsl_vector_view y_view = gsl_vector_subvector(y, 0, number_of_points);
+          if(gsl_multifit_linear(&X_view.matrix, &y_view.vector, c, cov, &chisq, ws) != GSL_SUCCESS)
+            return false;
+
+          /* store result ... */
+          for(int i=0; i < degree; i++)
+            result.push_back(gsl_vector_get(c, i));
+          return true;
+        }
 
-      /* store result ... */
-      for(i=0; i < degree; i++)
-        result.push_back(gsl_vector_get(c, i));
+      void release()
+      {
+        if(ws)
+          gsl_multifit_linear_free(ws);
+        if(X)
+          gsl_matrix_free(X);
+        if(y)
+          gsl_vector_free(y);
+        ws = NULL;
+        X = NULL;
+        y = NULL;
+        capacity = 0;
+      }
 
-      gsl_multifit_linear_free(ws);
-      gsl_matrix_free(X);
-      gsl_matrix_free(cov);
-      gsl_vector_free(y);
-      gsl_vector_free(c);
-      return true;
+      int degree;
+      size_t capacity;
+      gsl_matrix *X;
+      gsl_vector *y;
+      gsl_vector *c;
+      gsl_matrix *cov;
+      gsl_multifit_linear_workspace *ws;
+  };
+
+  //template for calculating a polynomial fit
+  //
+  //Parameters
+  //degree  ==> number of returned parameters (order of the polynom + 1)
+  //all dereferenced values must be double compatible
+  //the result will be a vector of coefficients with the highest order at the end
+  //use PolyFitter to fit many times without allocating memory for every fit
+  template<typename TIter1,typename TIter2,typename TResult>
+    bool fitPolynom(int degree, TIter1 start_iter_x,
+        TIter1 end_iter_x,
+        TIter2 start_iter_y,
+        TIter2 end_iter_y,
+        std::vector<TResult> &result,
+        double &chisq)
+    {
+      const size_t number_of_points = std::distance(start_iter_x, end_iter_x);
+      PolyFitter fitter(degree, number_of_points);
+      return fitter.fit(number_of_points, start_iter_x, start_iter_y, result, chisq);
     }
 
   template<typename TIter,typename TResult>
@@ -87,13 +193,9 @@ namespace numeric
         TIter end_iter,
         std::vector<TResult> &result,double &chisq)
     {
-      //generate x vector
-      std::vector<float> x;
-
-      TIter iter = start_iter;
-      for(int i=0;iter != end_iter;++i,++iter)
-        x.push_back(i);
-      return fitPolynom<typename std::vector<float>::iterator,TIter,TResult>(degree,x.begin(),x.end(),start_iter,end_iter,result,chisq);
+      const size_t number_of_points = std::distance(start_iter, end_iter);
+      PolyFitter fitter(degree, number_of_points);
+      return fitter.fit(number_of_points, start_iter, result, chisq);
     }
     
   //calculates the coefficients of a polynomial which is derivation of the given polynomial
@@ -2,45 +2,48 @@
 #define __NUMERIC_HISTOGRAM_HPP__
 
 #include <algorithm>
+#include <cassert>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+#include <Eigen/Core>
+#include "Parallel.hpp"
 
 namespace numeric
 {
 
-template <class T>
-struct Buckets
+/**
+ * Regular division of the interval [min_val, max_val] into count buckets.
+ * Maps values to bucket indices, values outside the interval are assigned
+ * to the first or the last bucket.
+ */
+struct BucketLayout
 {
     int count;
     double min_val, max_val;
-    std::vector<T> buckets;
 
-    Buckets( int count, double min_val, double max_val, const T& initial = T() )
-	: count( count ), min_val( min_val ), max_val( max_val ), buckets( count, initial )
+    BucketLayout( int count, double min_val, double max_val )
+	: count( count ), min_val( min_val ), max_val( max_val )
     {
 	assert( count > 0 );
 	assert( min_val < max_val );
     }
 
-    const T& operator[]( size_t idx ) const
+    /**
+     * Factor to convert the offset of a value to min_val into a bucket
+     * index, i.e. the reciprocal bucket width.
+     */
+    double getIndexScale() const
     {
-	return buckets[idx];
+	return count / (max_val - min_val);
     }
 
-    T& operator[]( size_t idx )
-    {
-	return buckets[idx];
-    }
-    
     size_t getIndex( double value ) const
     {
 	int idx = (value - min_val) / (max_val - min_val) * count;
 	return std::min( count-1, std::max( 0, idx ) );
     }
 
-    T& get( double value )
-    {
-	return buckets[ getIndex( value ) ];
-    }
-
     double getBucketWidth() const
     {
 	return (max_val - min_val)/count; 
@@ -60,6 +63,32 @@ struct Buckets
     {
 	return min_val + ( (idx+0.5) * getBucketWidth() );
     }
+};
+
+template <class T>
+struct Buckets : public BucketLayout
+{
+    std::vector<T> buckets;
+
+    Buckets( int count, double min_val, double max_val, const T& initial = T() )
+	: BucketLayout( count, min_val, max_val ), buckets( count, initial )
+    {
+    }
+
+    const T& operator[]( size_t idx ) const
+    {
+	return buckets[idx];
+    }
+
+    T& operator[]( size_t idx )
+    {
+	return buckets[idx];
+    }
+
+    T& get( double value )
+    {
+	return buckets[ getIndex( value ) ];
+    }
 
     size_t size() const
     {
@@ -82,11 +111,36 @@ struct Buckets
  *	cout << h[i] << endl;
  * @endcode
  *
+ * getCumulative(), cdf() and quantile() compute the prefix sums of the
+ * buckets on their first call after a modification and cache them. These
+ * const queries therefore write to the histogram, and concurrent calls
+ * need external synchronization. Once one of them has run after the last
+ * modification, the following calls only read.
  */
 struct Histogram : public Buckets<size_t>
 {
     size_t n;
 
+private:
+    /** inclusive prefix sums of the buckets, only valid if cumulative_valid */
+    mutable std::vector<size_t> cumulative;
+    mutable bool cumulative_valid;
+
+    const std::vector<size_t>& getPrefixSums() const
+    {
+	if( !cumulative_valid )
+	{
+	    cumulative.resize( buckets.size() );
+	    size_t sum = 0;
+	    for( size_t i = 0; i < buckets.size(); i++ )
+		cumulative[i] = sum += buckets[i];
+	    cumulative_valid = true;
+	}
+	return cumulative;
+    }
+
+public:
+
     /**
      * @brief Constructs a histogram where the number of update() calls with a value
      * that all into a bin are counted.
@@ -97,8 +151,38 @@ struct Histogram : public Buckets<size_t>
      *			min_val
      */
     Histogram( int count, double min_val, double max_val )
-	: Buckets<size_t>( count, min_val, max_val ), n(0)
+	: Buckets<size_t>( count, min_val, max_val ), n(0), cumulative_valid(false)
+    {
+    }
+
+    const size_t& operator[]( size_t idx ) const
+    {
+	return buckets[idx];
+    }
+
+    /**
+     * Mutable access to a bin. Invalidates the cumulative counts, if you
+     * modify the buckets vector directly call invalidate() afterwards.
+     */
+    size_t& operator[]( size_t idx )
+    {
+	cumulative_valid = false;
+	return buckets[idx];
+    }
+
+    size_t& get( double value )
+    {
+	cumulative_valid = false;
+	return buckets[ getIndex( value ) ];
+    }
+
+    /**
+     * Marks the cumulative counts as outdated, they are recomputed on the
+     * next query.
+     */
+    void invalidate()
     {
+	cumulative_valid = false;
     }
 
     /**
@@ -114,6 +198,111 @@ struct Histogram : public Buckets<size_t>
 	++get( value );
     }
 
+    /**
+     * Same as calling update() for every value in the range, but computes
+     * the bucket indices for blocks of values with vectorized operations.
+     * The indices are computed with the same rounding as getIndex(), so
+     * values on bucket edges are counted in the same bucket as by update().
+     * With more than one thread, the range is split into one part per thread,
+     * each thread fills a private set of counters and the counters are summed
+     * up afterwards.
+     *
+     * @param begin - pointer to the first value
+     * @param end - pointer past the last value
+     * @param threads - number of threads, 0 uses the hardware concurrency
+     */
+    void update( const double* begin, const double* end, size_t threads = 1 )
+    {
+	const size_t size = end - begin;
+	const size_t chunks = chunkCount( size, threads );
+	if( chunks == 1 )
+	{
+	    fill( begin, end, &buckets[0] );
+	}
+	else
+	{
+	    std::vector< std::vector<size_t> > partial( chunks, std::vector<size_t>( count, 0 ) );
+	    parallelChunks( size, chunks, [&]( size_t i, size_t b, size_t e )
+	    {
+		fill( begin + b, begin + e, &partial[i][0] );
+	    });
+	    for( size_t i = 0; i < chunks; i++ )
+		for( int j = 0; j < count; j++ )
+		    buckets[j] += partial[i][j];
+	}
+	n += size;
+	cumulative_valid = false;
+    }
+
+    /**
+     * Adds the counts of another histogram with the same interval and number
+     * of bins.
+     */
+    void merge( const Histogram& other )
+    {
+	if( other.count != count || other.min_val != min_val || other.max_val != max_val )
+	    throw std::invalid_argument("numeric::Histogram: can only merge histograms with the same layout.");
+	for( int i = 0; i < count; i++ )
+	    buckets[i] += other.buckets[i];
+	n += other.n;
+	cumulative_valid = false;
+    }
+
+    /**
+     * Reduces the resolution by combining factor neighbouring bins into one.
+     *
+     * @param factor - power of two, the number of bins needs to be divisible by it
+     */
+    void rebin( int factor = 2 )
+    {
+	if( factor <= 0 || (factor & (factor - 1)) || count % factor )
+	    throw std::invalid_argument("numeric::Histogram: rebin factor needs to be a power of two dividing the number of bins.");
+	count /= factor;
+	for( int i = 0; i < count; i++ )
+	{
+	    size_t sum = 0;
+	    for( int j = 0; j < factor; j++ )
+		sum += buckets[ i * factor + j ];
+	    buckets[i] = sum;
+	}
+	buckets.resize( count );
+	cumulative_valid = false;
+    }
+
+private:
+    /** adds the counts of the values in the range to counters */
+    void fill( const double* begin, const double* end, size_t* counters ) const
+    {
+	// small enough for the index buffer to stay in the L1 cache
+	static const int block_size = 1024;
+	const double range = max_val - min_val;
+	Eigen::Array<int, block_size, 1> idx;
+	std::vector<size_t> lanes( 4 * count, 0 );
+	for( ; begin < end; begin += block_size )
+	{
+	    const int len = std::min<ptrdiff_t>( block_size, end - begin );
+	    Eigen::Map<const Eigen::ArrayXd> values( begin, len );
+	    // same operations as getIndex(), multiplying with the reciprocal
+	    // width instead would move values on bucket edges
+	    idx.head( len ) = ((values - min_val) / range * count).cast<int>().max( 0 ).min( count - 1 );
+	    // consecutive values often hit the same bucket, spreading them over
+	    // several counter sets avoids stalling on the previous increment
+	    int i = 0;
+	    for( ; i + 4 <= len; i += 4 )
+	    {
+		++lanes[ idx[i] ];
+		++lanes[ count + idx[i+1] ];
+		++lanes[ 2 * count + idx[i+2] ];
+		++lanes[ 3 * count + idx[i+3] ];
+	    }
+	    for( ; i < len; i++ )
+		++lanes[ idx[i] ];
+	}
+	for( int j = 0; j < count; j++ )
+	    counters[j] += lanes[j] + lanes[count + j] + lanes[2 * count + j] + lanes[3 * count + j];
+    }
+
+public:
     /** 
      * return relative count in bin so that the integral over all bins would
      * result in 1.0. Note, that this is the integral and not the sum, so it
@@ -131,6 +320,54 @@ struct Histogram : public Buckets<size_t>
     {
 	return n;
     }
+
+    /**
+     * number of values in the bins up to and including idx. The prefix sums
+     * are computed once after an update and cached.
+     */
+    size_t getCumulative( size_t idx ) const
+    {
+	return getPrefixSums()[idx];
+    }
+
+    /**
+     * fraction of the values which are less or equal than value, assuming
+     * the values are evenly distributed within the bins.
+     */
+    double cdf( double value ) const
+    {
+	if( !n || value <= min_val )
+	    return 0.0;
+	if( value >= max_val )
+	    return 1.0;
+
+	const std::vector<size_t>& sums( getPrefixSums() );
+	const size_t idx = getIndex( value );
+	const double before = idx ? sums[idx-1] : 0;
+	const double fraction = (value - getLowerBound( idx )) / getBucketWidth();
+	return (before + fraction * buckets[idx]) / n;
+    }
+
+    /**
+     * value below which the fraction q of the values lies, assuming the
+     * values are evenly distributed within the bins. Uses a binary search
+     * on the cached prefix sums. Returns NaN for an empty histogram.
+     */
+    double quantile( double q ) const
+    {
+	if( !n )
+	    return std::numeric_limits<double>::quiet_NaN();
+
+	const std::vector<size_t>& sums( getPrefixSums() );
+	const double target = std::min( 1.0, std::max( 0.0, q ) ) * n;
+	// first bin whose prefix sum reaches the target
+	const size_t idx = std::min( buckets.size() - 1, size_t( std::lower_bound(
+			sums.begin(), sums.end(), target ) - sums.begin() ) );
+	const double before = idx ? sums[idx-1] : 0;
+	if( !buckets[idx] )
+	    return getLowerBound( idx );
+	return getLowerBound( idx ) + getBucketWidth() * (target - before) / buckets[idx];
+    }
 };
 
 }
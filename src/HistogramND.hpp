@@ -0,0 +1,208 @@
+#ifndef __NUMERIC_HISTOGRAM_ND_HPP__
+#define __NUMERIC_HISTOGRAM_ND_HPP__
+
+#include <vector>
+#include <Eigen/Core>
+#include "Histogram.hpp"
+
+namespace numeric
+{
+
+/**
+ * @brief D-dimensional histogram, e.g. for occupancy grids or joint
+ * distributions.
+ *
+ * Each axis is a BucketLayout with the same semantics as for Histogram,
+ * values outside the interval of an axis are counted in its first or last
+ * bucket. All counters are kept in one contiguous array in row-major order,
+ * i.e. the last axis is the one with consecutive counters.
+ *
+ * @code
+ * HistogramND<2> h( Eigen::Vector2i( 100, 50 ),
+ *	Eigen::Vector2d( 0.0, 0.0 ), Eigen::Vector2d( 10.0, 5.0 ) );
+ * h.update( points ); // 2 x N matrix
+ * HistogramND<1> x = h.marginalize( 1 );
+ * @endcode
+ */
+template <int D>
+class HistogramND
+{
+public:
+    typedef Eigen::Matrix<double, D, 1> Point;
+    typedef Eigen::Matrix<int, D, 1> Index;
+
+private:
+    std::vector<BucketLayout> axes_;
+    std::vector<size_t> counts_;
+    size_t n_;
+
+    Eigen::Array<double, D, 1> min_;
+    Eigen::Array<double, D, 1> scale_;
+    Eigen::Array<int, D, 1> max_idx_;
+    Index stride_;
+
+    void init()
+    {
+	size_t size = 1;
+	for( int d = D - 1; d >= 0; d-- )
+	{
+	    min_[d] = axes_[d].min_val;
+	    scale_[d] = axes_[d].getIndexScale();
+	    max_idx_[d] = axes_[d].count - 1;
+	    stride_[d] = size;
+	    size *= axes_[d].count;
+	}
+	counts_.assign( size, 0 );
+	n_ = 0;
+    }
+
+public:
+    /**
+     * @param axes - bucket layout for each of the D axes
+     */
+    explicit HistogramND( const std::vector<BucketLayout>& axes )
+	: axes_( axes )
+    {
+	assert( axes.size() == size_t(D) );
+	init();
+    }
+
+    /**
+     * @param count - number of buckets per axis
+     * @param min_val - lower bound per axis
+     * @param max_val - upper bound per axis, needs to be greater than min_val
+     */
+    HistogramND( const Index& count, const Point& min_val, const Point& max_val )
+    {
+	for( int d = 0; d < D; d++ )
+	    axes_.push_back( BucketLayout( count[d], min_val[d], max_val[d] ) );
+	init();
+    }
+
+    const BucketLayout& axis( int d ) const
+    {
+	return axes_[d];
+    }
+
+    /**
+     * position of the counter for the given bucket indices in the counter array
+     */
+    size_t getFlatIndex( const Index& idx ) const
+    {
+	return idx.dot( stride_ );
+    }
+
+    /**
+     * position of the counter for the bucket the point falls into
+     */
+    size_t getFlatIndex( const Point& p ) const
+    {
+	Index idx = ((p.array() - min_) * scale_).template cast<int>().max( 0 ).min( max_idx_ ).matrix();
+	return getFlatIndex( idx );
+    }
+
+    size_t operator[]( size_t flat_idx ) const
+    {
+	return counts_[flat_idx];
+    }
+
+    size_t operator()( const Index& idx ) const
+    {
+	return counts_[ getFlatIndex( idx ) ];
+    }
+
+    /**
+     * contiguous, row-major counter array
+     */
+    const std::vector<size_t>& data() const
+    {
+	return counts_;
+    }
+
+    size_t size() const
+    {
+	return counts_.size();
+    }
+
+    size_t total() const
+    {
+	return n_;
+    }
+
+    void clear()
+    {
+	std::fill( counts_.begin(), counts_.end(), 0 );
+	n_ = 0;
+    }
+
+    void update( const Point& p )
+    {
+	++counts_[ getFlatIndex( p ) ];
+	++n_;
+    }
+
+    /**
+     * @brief adds all points, which are given as the columns of a D x N matrix
+     *
+     * The bucket indices and the flat counter positions are computed for
+     * blocks of points with vectorized operations, only the increments
+     * remain scalar.
+     */
+    template <class Derived>
+    void update( const Eigen::MatrixBase<Derived>& points )
+    {
+	static const int block_size = 256;
+	Eigen::Matrix<int, D, block_size, Eigen::RowMajor> idx;
+	Eigen::Matrix<int, 1, block_size> flat;
+	const int n = points.cols();
+	for( int b = 0; b < n; b += block_size )
+	{
+	    const int len = std::min( block_size, n - b );
+	    for( int d = 0; d < D; d++ )
+		idx.row( d ).head( len ) = ((points.row( d ).segment( b, len ).array() - min_[d]) * scale_[d])
+		    .template cast<int>().max( 0 ).min( max_idx_[d] ).matrix();
+	    flat.head( len ) = stride_.transpose() * idx.leftCols( len );
+	    for( int i = 0; i < len; i++ )
+		++counts_[ flat[i] ];
+	}
+	n_ += n;
+    }
+
+    /**
+     * @brief sums up the counts along one axis
+     *
+     * The counters are summed up in place of the result, in a single pass
+     * over the counter array and without intermediate copies.
+     *
+     * @param axis - the axis which is summed out
+     */
+    HistogramND<D-1> marginalize( int axis ) const
+    {
+	std::vector<BucketLayout> axes( axes_ );
+	axes.erase( axes.begin() + axis );
+	HistogramND<D-1> result( axes );
+
+	// view the counters as [outer][axis][inner]
+	const size_t inner = stride_[axis];
+	const size_t count = axes_[axis].count;
+	const size_t outer = counts_.size() / (inner * count);
+	for( size_t o = 0; o < outer; o++ )
+	    for( size_t k = 0; k < count; k++ )
+	    {
+		const size_t* src = &counts_[ (o * count + k) * inner ];
+		size_t* dst = &result.counts_[ o * inner ];
+		for( size_t i = 0; i < inner; i++ )
+		    dst[i] += src[i];
+	    }
+	result.n_ = n_;
+	return result;
+    }
+
+    template <int> friend class HistogramND;
+
+    EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+};
+
+}
+
+#endif
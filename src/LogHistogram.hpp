@@ -0,0 +1,194 @@
+#ifndef __NUMERIC_LOG_HISTOGRAM_HPP__
+#define __NUMERIC_LOG_HISTOGRAM_HPP__
+
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+#include <math.h>
+#include <stdint.h>
+#include <string.h>
+
+namespace numeric
+{
+
+/**
+ * @brief Histogram with log-linear buckets, for data which spans many orders
+ * of magnitude like latencies or ranges.
+ *
+ * Every power of two between min_val and max_val is split into 2^precision
+ * buckets of equal width (HDR histogram layout), so the bucket width relative
+ * to its values is at most 2^-precision, independent of the magnitude. The
+ * bucket index is taken directly from the exponent and the upper mantissa
+ * bits of the IEEE 754 representation of the value, no log or division is
+ * needed.
+ *
+ * Like Histogram, values below min_val (including zero and negative values)
+ * are counted in the first bucket and values above max_val in the last one.
+ *
+ * @code
+ * // 1us to 100s with less than 1% relative error
+ * LogHistogram h( 1e-6, 100.0, 7 );
+ * h.update( latency );
+ * double p99 = h.quantile( 0.99 );
+ * @endcode
+ */
+class LogHistogram
+{
+    int precision_;
+    int min_exp_;
+    int max_exp_;
+    std::vector<size_t> buckets_;
+    size_t n_;
+
+    static uint64_t bits( double value )
+    {
+	uint64_t b;
+	memcpy( &b, &value, sizeof(b) );
+	return b;
+    }
+
+    /** unbiased binary exponent of a positive, normal value */
+    static int exponent( double value )
+    {
+	return int( (bits( value ) >> 52) & 0x7ff ) - 1023;
+    }
+
+public:
+    /**
+     * @param min_val - smallest value that is resolved, needs to be positive
+     * @param max_val - largest value that is resolved
+     * @param precision - number of mantissa bits used for the buckets, the
+     *	    relative bucket width is 2^-precision. Between 0 and 20.
+     */
+    LogHistogram( double min_val, double max_val, int precision = 7 )
+	: precision_( precision ), n_( 0 )
+    {
+	if( !(min_val > 0.0) || !(min_val < max_val) )
+	    throw std::invalid_argument("numeric::LogHistogram: need 0 < min_val < max_val.");
+	if( precision < 0 || precision > 20 )
+	    throw std::invalid_argument("numeric::LogHistogram: precision needs to be in [0, 20].");
+	if( !(min_val >= std::numeric_limits<double>::min()) || !(max_val <= std::numeric_limits<double>::max()) )
+	    throw std::invalid_argument("numeric::LogHistogram: bounds need to be normal numbers.");
+
+	min_exp_ = exponent( min_val );
+	max_exp_ = exponent( max_val );
+	buckets_.resize( size_t(max_exp_ - min_exp_ + 1) << precision_, 0 );
+    }
+
+    /**
+     * @brief index of the bucket a value falls into, O(1)
+     */
+    size_t getIndex( double value ) const
+    {
+	if( !(value >= getLowerBound( 0 )) )
+	    return 0;
+	const uint64_t b = bits( value );
+	const int e = int( (b >> 52) & 0x7ff ) - 1023;
+	if( e > max_exp_ )
+	    return buckets_.size() - 1;
+	const size_t sub = (b >> (52 - precision_)) & ((uint64_t(1) << precision_) - 1);
+	return (size_t(e - min_exp_) << precision_) + sub;
+    }
+
+    double getLowerBound( size_t idx ) const
+    {
+	const int e = min_exp_ + int( idx >> precision_ );
+	const size_t sub = idx & ((size_t(1) << precision_) - 1);
+	return ldexp( 1.0 + ldexp( double(sub), -precision_ ), e );
+    }
+
+    double getUpperBound( size_t idx ) const
+    {
+	const int e = min_exp_ + int( idx >> precision_ );
+	return getLowerBound( idx ) + ldexp( 1.0, e - precision_ );
+    }
+
+    double getCenter( size_t idx ) const
+    {
+	return (getLowerBound( idx ) + getUpperBound( idx )) / 2.0;
+    }
+
+    /**
+     * @brief maximum width of a bucket relative to its lower bound
+     */
+    double getRelativeError() const
+    {
+	return ldexp( 1.0, -precision_ );
+    }
+
+    size_t operator[]( size_t idx ) const
+    {
+	return buckets_[idx];
+    }
+
+    size_t size() const
+    {
+	return buckets_.size();
+    }
+
+    /**
+     * @brief increase the count of the bucket the value falls into
+     */
+    void update( double value, size_t count = 1 )
+    {
+	buckets_[ getIndex( value ) ] += count;
+	n_ += count;
+    }
+
+    /**
+     * @brief add the counts of another histogram with the same layout
+     */
+    void merge( const LogHistogram& other )
+    {
+	if( other.precision_ != precision_ || other.min_exp_ != min_exp_ || other.max_exp_ != max_exp_ )
+	    throw std::invalid_argument("numeric::LogHistogram: can only merge histograms with the same layout.");
+	for( size_t i = 0; i < buckets_.size(); i++ )
+	    buckets_[i] += other.buckets_[i];
+	n_ += other.n_;
+    }
+
+    void clear()
+    {
+	std::fill( buckets_.begin(), buckets_.end(), 0 );
+	n_ = 0;
+    }
+
+    /**
+     * @brief value below which the fraction q of the values lies
+     *
+     * Interpolates linearly within the bucket, so the relative error is at
+     * most getRelativeError() for values inside [min_val, max_val]. Returns
+     * NaN if the histogram is empty.
+     */
+    double quantile( double q ) const
+    {
+	if( !n_ )
+	    return std::numeric_limits<double>::quiet_NaN();
+
+	const double target = std::min( 1.0, std::max( 0.0, q ) ) * n_;
+	double sum = 0;
+	for( size_t i = 0; i < buckets_.size(); i++ )
+	{
+	    if( !buckets_[i] )
+		continue;
+	    if( sum + buckets_[i] >= target )
+		return getLowerBound( i ) + (getUpperBound( i ) - getLowerBound( i ))
+		    * (target - sum) / buckets_[i];
+	    sum += buckets_[i];
+	}
+	return getUpperBound( buckets_.size() - 1 );
+    }
+
+    /**
+     * total number of values in the bins
+     */
+    size_t total() const
+    {
+	return n_;
+    }
+};
+
+}
+
+#endif
@@ -0,0 +1,101 @@
+#ifndef __NUMERIC_PARALLEL_HPP__
+#define __NUMERIC_PARALLEL_HPP__
+
+#include <algorithm>
+#include <thread>
+#include <vector>
+
+namespace numeric
+{
+
+/**
+ * @brief number of threads used by the parallel drivers if none is given
+ *
+ * Falls back to one thread if the hardware concurrency can not be determined.
+ */
+inline size_t defaultThreadCount()
+{
+    size_t threads = std::thread::hardware_concurrency();
+    return threads ? threads : 1;
+}
+
+/**
+ * @brief number of chunks a range of count items is split into
+ *
+ * @param count - number of items in the range
+ * @param threads - maximum number of threads, 0 selects defaultThreadCount()
+ */
+inline size_t chunkCount( size_t count, size_t threads = 0 )
+{
+    if( !threads )
+	threads = defaultThreadCount();
+    return std::max( size_t(1), std::min( threads, count ) );
+}
+
+/**
+ * @brief start index of a chunk, when splitting count items into chunks parts
+ *
+ * The end of chunk i is the begin of chunk i+1.
+ */
+inline size_t chunkBegin( size_t count, size_t chunks, size_t i )
+{
+    return count / chunks * i + std::min( i, count % chunks );
+}
+
+/**
+ * @brief joins all threads of a vector when going out of scope
+ *
+ * Keeps the started threads from being destroyed while still joinable,
+ * which would terminate the program, when an exception leaves the scope.
+ */
+struct ThreadJoiner
+{
+    std::vector<std::thread>& threads;
+
+    explicit ThreadJoiner( std::vector<std::thread>& threads )
+	: threads( threads ) {}
+
+    ~ThreadJoiner()
+    {
+	for( size_t i = 0; i < threads.size(); i++ )
+	    if( threads[i].joinable() )
+		threads[i].join();
+    }
+};
+
+/**
+ * @brief calls f( i, begin, end ) for each chunk of the range [0, count)
+ *
+ * Each chunk runs on its own thread, the first one on the calling thread.
+ * The function returns after all chunks are processed. Results are
+ * typically written to a per chunk slot indexed by i and reduced by the
+ * caller afterwards, so that the workers never share state.
+ *
+ * Every call starts chunks - 1 new threads, which costs in the order of
+ * tens of microseconds. Only use it for ranges large enough to outweigh
+ * that, and not in loops running at kHz rates.
+ *
+ * If starting a thread or the chunk on the calling thread throws, the
+ * exception is rethrown after all started threads finished. Exceptions
+ * thrown by f on the other threads terminate the program, as for any
+ * std::thread.
+ *
+ * @param count - number of items in the range
+ * @param chunks - number of chunks, see chunkCount()
+ * @param f - functor with signature void( size_t i, size_t begin, size_t end )
+ */
+template <class F>
+void parallelChunks( size_t count, size_t chunks, F f )
+{
+    std::vector<std::thread> workers;
+    workers.reserve( chunks );
+    ThreadJoiner joiner( workers );
+    for( size_t i = 1; i < chunks; i++ )
+	workers.push_back( std::thread( f, i,
+		    chunkBegin( count, chunks, i ), chunkBegin( count, chunks, i + 1 ) ) );
+
+    f( size_t(0), chunkBegin( count, chunks, 0 ), chunkBegin( count, chunks, 1 ) );
+}
+}
+
+#endif
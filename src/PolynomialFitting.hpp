@@ -0,0 +1,456 @@
+#ifndef __NUMERIC_POLYNOMIAL_FITTING_HPP__
+#define __NUMERIC_POLYNOMIAL_FITTING_HPP__
+
+#include <Eigen/Core>
+#include <Eigen/QR>
+#include <Eigen/Cholesky>
+#include <algorithm>
+#include <iterator>
+#include <stdexcept>
+#include <vector>
+
+namespace numeric
+{
+
+/**
+ * Least-squares polynomial fit with a Householder QR decomposition.
+ *
+ * Same interface and results as PolyFitter in FitPolynom.hpp, but without
+ * gsl. The Vandermonde matrix is stored column-major and built a column at
+ * a time, each column being the previous one multiplied by x, so no pow()
+ * is needed. The matrices are kept between calls and only grow.
+ */
+class QRPolyFitter
+{
+public:
+    /**
+     * @param degree number of returned coefficients (order of the polynom + 1)
+     * @param max_points number of points the matrices are allocated for
+     */
+    explicit QRPolyFitter( int degree, size_t max_points = 0 ) :
+	degree( degree )
+    {
+	if( degree <= 0 )
+	    throw std::invalid_argument( "QRPolyFitter: degree must be positive" );
+	reserve( std::max( max_points, (size_t)degree ) );
+    }
+
+    int getDegree() const { return degree; }
+    size_t getCapacity() const { return X.rows(); }
+
+    /** grows the matrices so that fits of up to number_of_points do not allocate */
+    void reserve( size_t number_of_points )
+    {
+	if( number_of_points <= (size_t)X.rows() )
+	    return;
+	X.resize( number_of_points, degree );
+	x.resize( number_of_points );
+	y.resize( number_of_points );
+    }
+
+    /**
+     * @brief fits number_of_points points given by x and y
+     *
+     * @param result coefficients, lowest order first
+     * @param chisq sum of the squared residuals
+     */
+    template <class TIter1, class TIter2, class TResult>
+    bool fit( size_t number_of_points, TIter1 start_iter_x, TIter2 start_iter_y,
+	    std::vector<TResult>& result, double& chisq )
+    {
+	reserve( number_of_points );
+	for( size_t i = 0; i < number_of_points; ++i, ++start_iter_x, ++start_iter_y )
+	{
+	    x[i] = *start_iter_x;
+	    y[i] = *start_iter_y;
+	}
+	return solve( number_of_points, result, chisq );
+    }
+
+    /** fits the points in [start_iter_x, end_iter_x) */
+    template <class TIter1, class TIter2, class TResult>
+    bool fit( TIter1 start_iter_x, TIter1 end_iter_x, TIter2 start_iter_y,
+	    std::vector<TResult>& result, double& chisq )
+    {
+	return fit( std::distance( start_iter_x, end_iter_x ), start_iter_x, start_iter_y, result, chisq );
+    }
+
+    /** fits the values in [start_iter, end_iter) over their indices 0, 1, 2, ... */
+    template <class TIter, class TResult>
+    bool fit( TIter start_iter, TIter end_iter, std::vector<TResult>& result, double& chisq )
+    {
+	size_t number_of_points = std::distance( start_iter, end_iter );
+	reserve( number_of_points );
+	for( size_t i = 0; i < number_of_points; ++i, ++start_iter )
+	{
+	    x[i] = i;
+	    y[i] = *start_iter;
+	}
+	return solve( number_of_points, result, chisq );
+    }
+
+private:
+    template <class TResult>
+    bool solve( size_t number_of_points, std::vector<TResult>& result, double& chisq )
+    {
+	result.clear();
+	if( number_of_points < (size_t)degree )
+	    return false;
+
+	const int n = number_of_points;
+	X.col( 0 ).head( n ).setOnes();
+	for( int j = 1; j < degree; j++ )
+	    X.col( j ).head( n ) = X.col( j-1 ).head( n ).cwiseProduct( x.head( n ) );
+
+	qr.compute( X.topRows( n ) );
+	c = qr.solve( y.head( n ) );
+	chisq = ( X.topRows( n ) * c - y.head( n ) ).squaredNorm();
+
+	for( int i = 0; i < degree; i++ )
+	    result.push_back( c[i] );
+	return true;
+    }
+
+    int degree;
+    Eigen::MatrixXd X;
+    Eigen::VectorXd x, y, c;
+    Eigen::HouseholderQR<Eigen::MatrixXd> qr;
+};
+
+/**
+ * @brief polynomial fit without gsl, see fitPolynom()
+ *
+ * @param degree number of returned coefficients (order of the polynom + 1)
+ * @param result coefficients, lowest order first
+ * @param chisq sum of the squared residuals
+ */
+template <class TIter1, class TIter2, class TResult>
+bool fitPolynomQR( int degree, TIter1 start_iter_x, TIter1 end_iter_x,
+	TIter2 start_iter_y, std::vector<TResult>& result, double& chisq )
+{
+    QRPolyFitter fitter( degree, std::distance( start_iter_x, end_iter_x ) );
+    return fitter.fit( start_iter_x, end_iter_x, start_iter_y, result, chisq );
+}
+
+/** polynomial fit of the values in [start_iter, end_iter) over their indices */
+template <class TIter, class TResult>
+bool fitPolynomQR( int degree, TIter start_iter, TIter end_iter,
+	std::vector<TResult>& result, double& chisq )
+{
+    QRPolyFitter fitter( degree, std::distance( start_iter, end_iter ) );
+    return fitter.fit( start_iter, end_iter, result, chisq );
+}
+
+/**
+ * Online least-squares polynomial fit y = c_0 + c_1 x + ... + c_Order x^Order.
+ *
+ * Like PlaneFitting, only the sums of the normal equations are stored, that
+ * is the sums of x^k for k up to 2*Order, of x^k*y for k up to Order and of
+ * y^2. Adding or removing a point costs O(Order), the solution is computed
+ * on demand from the sums.
+ *
+ * The sums of powers lose precision when x is far from the origin, and
+ * removing points subtracts from the sums, so rounding errors accumulate.
+ * shift() amplifies the errors of the lower sums by powers of dx, calling
+ * it for every sample of a long running signal makes them grow without
+ * bound. For fits over the last N samples of a signal use
+ * SlidingPolynomialFit, which bounds the errors by rebuilding the sums.
+ */
+template <class Scalar, int Order>
+class PolynomialFitting
+{
+public:
+    enum { Coefficients = Order + 1, Powers = 2 * Order + 1 };
+    typedef typename Eigen::Matrix<Scalar,Coefficients,1> Vector;
+    typedef typename Eigen::Matrix<Scalar,Coefficients,Coefficients> Matrix;
+
+    /** sum of w*x^k, k = 0..2*Order */
+    Eigen::Matrix<Scalar,Powers,1> xk;
+    /** sum of w*x^k*y, k = 0..Order */
+    Vector xky;
+    /** sum of w*y^2 */
+    Scalar yy;
+
+    PolynomialFitting()
+    {
+	clear();
+    }
+
+    /**
+     * @brief clears all previous input to the update method
+     */
+    void clear()
+    {
+	xk.setZero();
+	xky.setZero();
+	yy = 0;
+    }
+
+    /** sum of the weights */
+    Scalar n() const
+    {
+	return xk[0];
+    }
+
+    /**
+     * @brief scale the statistics
+     * Note that this will not have influence on the solution,
+     * but will only change the relative weighting towards additional datums.
+     */
+    void scale( Scalar scale )
+    {
+	xk *= scale;
+	xky *= scale;
+	yy *= scale;
+    }
+
+    void update( const PolynomialFitting& other )
+    {
+	xk += other.xk;
+	xky += other.xky;
+	yy += other.yy;
+    }
+
+    /** adds the point (x, y), a negative weight removes it again */
+    void update( Scalar x, Scalar y, Scalar weight = 1.0 )
+    {
+	Scalar p = weight;
+	for( int k = 0; k < Coefficients; k++, p *= x )
+	{
+	    xk[k] += p;
+	    xky[k] += p * y;
+	}
+	for( int k = Coefficients; k < Powers; k++, p *= x )
+	    xk[k] += p;
+	yy += weight * y * y;
+    }
+
+    /** removes a point that was added with update() before */
+    void remove( Scalar x, Scalar y, Scalar weight = 1.0 )
+    {
+	update( x, y, -weight );
+    }
+
+    /**
+     * @brief moves the origin of x to dx
+     *
+     * Afterwards, all points added before are at x - dx, and the
+     * coefficients refer to the new origin. Costs O(Order^2).
+     */
+    void shift( Scalar dx )
+    {
+	// sum (x-dx)^k = sum_j binomial(k,j) (-dx)^(k-j) sum x^j, from the highest k down,
+	// so the lower sums are still the old ones when they are used
+	for( int k = Powers - 1; k > 0; k-- )
+	{
+	    Scalar c = 1, p = 1;
+	    Scalar sk = xk[k], sky = k < Coefficients ? xky[k] : 0;
+	    for( int j = k - 1; j >= 0; j-- )
+	    {
+		c = c * (j + 1) / (k - j);
+		p *= -dx;
+		sk += c * p * xk[j];
+		if( k < Coefficients )
+		    sky += c * p * xky[j];
+	    }
+	    xk[k] = sk;
+	    if( k < Coefficients )
+		xky[k] = sky;
+	}
+    }
+
+    class Result
+    {
+	Eigen::LDLT<Matrix> ldlt;
+	Vector coeffs;
+	Scalar res;
+
+    public:
+	explicit Result( const PolynomialFitting& sum )
+	{
+	    Matrix A;
+	    for( int i = 0; i < Coefficients; i++ )
+		for( int j = 0; j < Coefficients; j++ )
+		    A(i, j) = sum.xk[i + j];
+
+	    ldlt.compute( A );
+	    coeffs = ldlt.solve( sum.xky );
+	    res = sum.yy - sum.xky.dot(coeffs); // == sum.yy - 2*b^T*coeffs + coeffs^T*A*coeffs
+	}
+
+	/** coefficients, lowest order first */
+	const Vector& getCoeffs() const
+	{
+	    return coeffs;
+	}
+
+	Scalar getResiduals() const
+	{
+	    return res;
+	}
+
+	Matrix getCovariance() const
+	{
+	    Matrix cov =
+		getResiduals() * ldlt.solve( Matrix::Identity() );
+	    return cov;
+	}
+    };
+
+    /**
+     * @brief Solve the regression and return a result object
+     *
+     * the result object can be queried for different aspects
+     * like coefficients, residuals or covariance matrix.
+     * Costs O(Order^3), independent of the number of points.
+     */
+    Result solve() const
+    {
+	return Result( *this );
+    }
+
+    /**
+     * @brief Get the coefficients of the fitted polynomial, lowest order first.
+     *
+     * Note this function will call the solve function internally.
+     */
+    Vector getCoeffs() const
+    {
+	return solve().getCoeffs();
+    }
+
+    EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+};
+
+/**
+ * Least-squares polynomial fit over the last N samples of a signal, in
+ * constant time per sample.
+ *
+ * The samples are equally spaced, the fit is returned with x in samples
+ * relative to the newest sample, so the newest sample is at x = 0 and the
+ * oldest at x = -(N-1). c_0 is the smoothed value at the newest sample and
+ * c_1 the slope per sample.
+ *
+ * The samples of the window are kept in a ring buffer, and each update adds
+ * the new sample to the PolynomialFitting sums and removes the oldest one,
+ * with x relative to a fixed origin instead of shifting the sums every
+ * sample. Every N samples, the sums are rebuilt from the ring buffer with
+ * the origin at the newest sample. So the rounding errors of at most 2N
+ * additions and removals are in the sums, however long the signal runs,
+ * and the update costs O(Order) amortized. solve() shifts a copy of the
+ * sums to the newest sample, which costs O(Order^2).
+ *
+ * @code
+ * SlidingPolynomialFit<double, 2> fit( 32 );
+ * for( ... )
+ * {
+ *     fit.update( value );
+ *     double smoothed = fit.getCoeffs()[0];
+ * }
+ * @endcode
+ */
+template <class Scalar, int Order>
+class SlidingPolynomialFit
+{
+public:
+    typedef PolynomialFitting<Scalar, Order> Sums;
+    typedef typename Sums::Vector Vector;
+    typedef typename Sums::Result Result;
+
+    /**
+     * @param window number of samples in the window, needs to be greater than Order
+     */
+    explicit SlidingPolynomialFit( size_t window )
+	: samples_( window )
+    {
+	if( window <= (size_t)Order )
+	    throw std::invalid_argument( "numeric::SlidingPolynomialFit: window needs to be bigger than the polynomial order." );
+	clear();
+    }
+
+    void clear()
+    {
+	sums_.clear();
+	head_ = 0;
+	size_ = 0;
+	next_x_ = 0;
+	updates_ = 0;
+    }
+
+    /** Adds the newest sample, and removes the oldest if the window is full */
+    void update( Scalar y )
+    {
+	const size_t window = samples_.size();
+	if( size_ == window )
+	{
+	    sums_.remove( next_x_ - Scalar( size_ ), samples_[head_] );
+	    head_ = (head_ + 1) % window;
+	    size_--;
+	}
+	samples_[ (head_ + size_) % window ] = y;
+	size_++;
+	sums_.update( next_x_, y );
+	next_x_ += 1;
+
+	if( ++updates_ >= window )
+	    rebuild();
+    }
+
+    /** number of samples in the window */
+    size_t n() const
+    {
+	return size_;
+    }
+
+    /** true once the window holds N samples */
+    bool full() const
+    {
+	return size_ == samples_.size();
+    }
+
+    /**
+     * @brief Solve the regression over the samples in the window
+     *
+     * Needs at least Order + 1 samples in the window.
+     */
+    Result solve() const
+    {
+	Sums sums( sums_ );
+	sums.shift( next_x_ - 1 );
+	return sums.solve();
+    }
+
+    /** coefficients, lowest order first, x relative to the newest sample */
+    Vector getCoeffs() const
+    {
+	return solve().getCoeffs();
+    }
+
+private:
+    /** recomputes the sums from the ring buffer, the newest sample at x = 0 */
+    void rebuild()
+    {
+	const size_t window = samples_.size();
+	sums_.clear();
+	for( size_t i = 0; i < size_; i++ )
+	    sums_.update( Scalar( i ) - Scalar( size_ - 1 ), samples_[ (head_ + i) % window ] );
+	next_x_ = 1;
+	updates_ = 0;
+    }
+
+    Sums sums_;
+    std::vector<Scalar> samples_;
+    size_t head_;
+    size_t size_;
+    /** x of the next sample, relative to the origin of the sums */
+    Scalar next_x_;
+    /** updates since the last rebuild */
+    size_t updates_;
+
+public:
+    EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+};
+
+}
+
+#endif
@@ -0,0 +1,282 @@
+#ifndef __NUMERIC_QUANTILE_SKETCH_HPP__
+#define __NUMERIC_QUANTILE_SKETCH_HPP__
+
+#include <algorithm>
+#include <limits>
+#include <vector>
+#include <math.h>
+#include <stdexcept>
+
+namespace numeric
+{
+
+/**
+ * Fixed memory sketch to estimate quantiles (median, percentiles) of a
+ * stream of values, without storing and sorting the whole series.
+ *
+ * Implements the merging t-digest of
+ *
+ * T. Dunning, O. Ertl (2019): Computing Extremely Accurate Quantiles Using t-Digests
+ *
+ * Values are collected in a small buffer, which is merged into a sorted set of
+ * weighted centroids when full. The centroid size is limited by the arcsine
+ * scale function, so the centroids are small at the tails and the relative
+ * error of extreme quantiles stays low. The number of centroids is bounded
+ * by the compression parameter, independent of the number of values.
+ * Like Stats, the sketch supports weighted values, and two sketches can be
+ * merged, e.g. after accumulating them on different threads.
+ *
+ * quantile(), median() and centroidCount() first merge the buffered values
+ * into the centroids, and so does merge() for the sketch passed to it. So
+ * although they are const, they change the internal state. A sketch shared
+ * between threads needs a lock for these calls, unless flush() was called
+ * after the last update, in which case they only read.
+ *
+ * @code
+ * QuantileSketch s;
+ * for( ... ) s.update( latency );
+ * double p99 = s.quantile( 0.99 );
+ * @endcode
+ */
+class QuantileSketch
+{
+public:
+    struct Centroid
+    {
+	double mean;
+	double weight;
+
+	bool operator<( const Centroid& other ) const { return mean < other.mean; }
+    };
+
+private:
+    double compression_;
+
+    mutable std::vector<Centroid> centroids_;
+    mutable std::vector<Centroid> buffer_;
+    mutable std::vector<Centroid> merged_;
+
+    double min_;
+    double max_;
+    double sum_weight_;
+    size_t n_;
+
+    /** scale function k(q) and its inverse */
+    double k( double q ) const
+    {
+	return compression_ / (2.0 * M_PI) * asin( 2.0 * q - 1.0 );
+    }
+
+    double kInv( double k ) const
+    {
+	if( k >= compression_ / 4.0 )
+	    return 1.0;
+	return (sin( k * 2.0 * M_PI / compression_ ) + 1.0) / 2.0;
+    }
+
+public:
+    /**
+     * @brief merges the buffered values into the centroids
+     *
+     * Called by the queries when needed. Calling it after the last update
+     * makes the const queries read-only, e.g. to query from several threads.
+     */
+    void flush() const
+    {
+	if( buffer_.empty() )
+	    return;
+
+	// the centroids are sorted already, only the buffer needs sorting
+	std::sort( buffer_.begin(), buffer_.end() );
+	merged_.resize( buffer_.size() + centroids_.size() );
+	std::merge( buffer_.begin(), buffer_.end(), centroids_.begin(), centroids_.end(), merged_.begin() );
+
+	double total = 0;
+	for( size_t i = 0; i < merged_.size(); i++ )
+	    total += merged_[i].weight;
+
+	centroids_.clear();
+	Centroid cur = merged_[0];
+	double w_so_far = 0;
+	double q_limit = kInv( k( 0.0 ) + 1.0 );
+	for( size_t i = 1; i < merged_.size(); i++ )
+	{
+	    const Centroid& next( merged_[i] );
+	    if( (w_so_far + cur.weight + next.weight) / total <= q_limit )
+	    {
+		cur.weight += next.weight;
+		cur.mean += (next.mean - cur.mean) * next.weight / cur.weight;
+	    }
+	    else
+	    {
+		w_so_far += cur.weight;
+		centroids_.push_back( cur );
+		q_limit = kInv( k( w_so_far / total ) + 1.0 );
+		cur = next;
+	    }
+	}
+	centroids_.push_back( cur );
+
+	buffer_.clear();
+    }
+
+private:
+    /** number of values collected before they are merged into the centroids */
+    size_t bufferSize() const
+    {
+	return 20 * size_t(compression_);
+    }
+
+    void add( double value, double weight )
+    {
+	if( buffer_.size() >= bufferSize() )
+	    flush();
+	Centroid c = { value, weight };
+	buffer_.push_back( c );
+    }
+
+public:
+    /**
+     * @param compression - controls the accuracy and the size of the sketch.
+     *	    The number of centroids is at most about compression / 2 after
+     *	    merging.
+     */
+    explicit QuantileSketch( double compression = 100.0 )
+	: compression_( compression )
+    {
+	if( compression < 10.0 )
+	    throw std::invalid_argument("numeric::QuantileSketch: compression needs to be at least 10.");
+	buffer_.reserve( bufferSize() );
+	centroids_.reserve( size_t(compression) );
+	merged_.reserve( bufferSize() + size_t(compression) );
+	clear();
+    }
+
+    void clear()
+    {
+	centroids_.clear();
+	buffer_.clear();
+	min_ = std::numeric_limits<double>::infinity();
+	max_ = -std::numeric_limits<double>::infinity();
+	sum_weight_ = 0.0;
+	n_ = 0;
+    }
+
+    /**
+     * @brief add a value to the sketch
+     *
+     * @param value - value to add
+     * @param weight - weight of the value, needs to be positive
+     */
+    void update( double value, double weight = 1.0 )
+    {
+	if( !(weight > 0.0) )
+	    return;
+	add( value, weight );
+	min_ = std::min( min_, value );
+	max_ = std::max( max_, value );
+	sum_weight_ += weight;
+	n_++;
+    }
+
+    /**
+     * @brief merges the values of another sketch into this one
+     */
+    void merge( const QuantileSketch& other )
+    {
+	other.flush();
+	for( size_t i = 0; i < other.centroids_.size(); i++ )
+	    add( other.centroids_[i].mean, other.centroids_[i].weight );
+	min_ = std::min( min_, other.min_ );
+	max_ = std::max( max_, other.max_ );
+	sum_weight_ += other.sum_weight_;
+	n_ += other.n_;
+    }
+
+    /**
+     * @brief estimated value below which the fraction q of the weights lies
+     *
+     * The estimate interpolates linearly between the centroids, min and max
+     * are exact. Returns NaN if the sketch is empty.
+     *
+     * @param q - quantile in [0, 1]
+     */
+    double quantile( double q ) const
+    {
+	if( !n_ )
+	    return std::numeric_limits<double>::quiet_NaN();
+	if( q <= 0.0 )
+	    return min_;
+	if( q >= 1.0 )
+	    return max_;
+
+	flush();
+
+	const double target = q * sum_weight_;
+	const Centroid& first( centroids_.front() );
+	if( target < first.weight / 2.0 )
+	    return min_ + (first.mean - min_) * target / (first.weight / 2.0);
+
+	double w_so_far = first.weight / 2.0;
+	for( size_t i = 1; i < centroids_.size(); i++ )
+	{
+	    const Centroid& a( centroids_[i-1] );
+	    const Centroid& b( centroids_[i] );
+	    double dw = (a.weight + b.weight) / 2.0;
+	    if( target < w_so_far + dw )
+		return a.mean + (b.mean - a.mean) * (target - w_so_far) / dw;
+	    w_so_far += dw;
+	}
+
+	const Centroid& last( centroids_.back() );
+	double rest = last.weight / 2.0;
+	return last.mean + (max_ - last.mean) * std::min( 1.0, (target - w_so_far) / rest );
+    }
+
+    double median() const
+    {
+	return quantile( 0.5 );
+    }
+
+    double min() const
+    {
+	return min_;
+    }
+
+    double max() const
+    {
+	return max_;
+    }
+
+    double sumWeights() const
+    {
+	return sum_weight_;
+    }
+
+    size_t n() const
+    {
+	return n_;
+    }
+
+    /**
+     * @brief memory used by the sketch in bytes, independent of the number of values
+     */
+    size_t memoryUsage() const
+    {
+	return sizeof(*this) + (buffer_.capacity() + centroids_.capacity()
+		+ merged_.capacity()) * sizeof(Centroid);
+    }
+
+    /**
+     * @brief number of centroids the values are currently compressed to
+     */
+    size_t centroidCount() const
+    {
+	flush();
+	return centroids_.size();
+    }
+};
+
+}
+
+#endif
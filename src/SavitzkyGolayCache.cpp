@@ -0,0 +1,133 @@
+#include "SavitzkyGolayCache.hpp"
+#include "SavitzkyGolayFilter.hpp"
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <stdint.h>
+
+namespace numeric
+{
+namespace
+{
+
+struct Entry
+{
+    int ls_point, half_width, poly_order, derivative;
+    std::vector<double> coefficients;
+
+    bool matches(int t, int m, int n, int s) const
+    {
+        return ls_point == t && half_width == m && poly_order == n && derivative == s;
+    }
+};
+
+uint64_t hash(int t, int m, int n, int s)
+{
+    uint64_t x = (uint64_t(uint32_t(t)) << 48) ^ (uint64_t(uint32_t(m)) << 32)
+        ^ (uint64_t(uint32_t(n)) << 16) ^ uint64_t(uint32_t(s));
+    // splitmix64 finalizer
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+    return x ^ (x >> 31);
+}
+
+/** open addressing hash table with linear probing, size is a power of two */
+struct Table
+{
+    size_t capacity;
+    std::unique_ptr< std::atomic<const Entry*>[] > slots;
+
+    explicit Table(size_t capacity)
+        : capacity(capacity), slots(new std::atomic<const Entry*>[capacity])
+    {
+        for (size_t i = 0; i < capacity; i++)
+            slots[i].store(0, std::memory_order_relaxed);
+    }
+
+    const Entry* find(int t, int m, int n, int s) const
+    {
+        for (size_t i = hash(t, m, n, s) & (capacity - 1);; i = (i + 1) & (capacity - 1))
+        {
+            const Entry* e = slots[i].load(std::memory_order_acquire);
+            if (!e || e->matches(t, m, n, s))
+                return e;
+        }
+    }
+
+    /** only called with the mutex held */
+    void insert(const Entry* e)
+    {
+        size_t i = hash(e->ls_point, e->half_width, e->poly_order, e->derivative) & (capacity - 1);
+        while (slots[i].load(std::memory_order_relaxed))
+            i = (i + 1) & (capacity - 1);
+        slots[i].store(e, std::memory_order_release);
+    }
+};
+
+struct Cache
+{
+    std::atomic<const Table*> table;
+    std::mutex mutex;
+    std::vector< std::unique_ptr<Table> > tables;
+    std::vector< std::unique_ptr<Entry> > entries;
+
+    Cache()
+    {
+        tables.push_back(std::unique_ptr<Table>(new Table(64)));
+        table.store(tables.back().get());
+    }
+};
+
+Cache& cache()
+{
+    static Cache instance;
+    return instance;
+}
+
+}
+
+SavitzkyGolayCoefficients SavitzkyGolayCache::get(int ls_point, int half_width, int poly_order, int derivative)
+{
+    Cache& c(cache());
+    const Entry* e = c.table.load(std::memory_order_acquire)->find(ls_point, half_width, poly_order, derivative);
+    if (!e)
+    {
+        // compute outside of the lock, a concurrent insert of the same
+        // design wins and this result is dropped
+        std::unique_ptr<Entry> entry(new Entry());
+        SavitzkyGolayFilter(entry->coefficients, ls_point, half_width, poly_order, derivative);
+        entry->ls_point = ls_point;
+        entry->half_width = half_width;
+        entry->poly_order = poly_order;
+        entry->derivative = derivative;
+
+        std::lock_guard<std::mutex> lock(c.mutex);
+        Table* table = c.tables.back().get();
+        e = table->find(ls_point, half_width, poly_order, derivative);
+        if (!e)
+        {
+            // keep the load factor below 1/2, readers of the old table
+            // which miss the new entry end up here and find it
+            if (2 * (c.entries.size() + 1) > table->capacity)
+            {
+                c.tables.push_back(std::unique_ptr<Table>(new Table(2 * table->capacity)));
+                table = c.tables.back().get();
+                for (size_t i = 0; i < c.entries.size(); i++)
+                    table->insert(c.entries[i].get());
+                c.table.store(table, std::memory_order_release);
+            }
+            e = entry.get();
+            c.entries.push_back(std::move(entry));
+            table->insert(e);
+        }
+    }
+    return SavitzkyGolayCoefficients(&e->coefficients[0], e->coefficients.size());
+}
+
+size_t SavitzkyGolayCache::size()
+{
+    Cache& c(cache());
+    std::lock_guard<std::mutex> lock(c.mutex);
+    return c.entries.size();
+}
+}
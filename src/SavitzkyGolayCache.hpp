@@ -0,0 +1,66 @@
+#ifndef __NUMERIC_SAVITZKY_GOLAY_CACHE_HPP__
+#define __NUMERIC_SAVITZKY_GOLAY_CACHE_HPP__
+
+#include <stdlib.h>
+
+namespace numeric
+{
+/**
+ * Read-only view of Savitzky-Golay coefficients owned by the
+ * SavitzkyGolayCache. Valid until the end of the process.
+ */
+class SavitzkyGolayCoefficients
+{
+public:
+    SavitzkyGolayCoefficients(const double* data, size_t size)
+        : data_(data), size_(size) {}
+
+    const double& operator[](size_t i) const { return data_[i]; }
+    const double* data() const { return data_; }
+    const double* begin() const { return data_; }
+    const double* end() const { return data_ + size_; }
+    size_t size() const { return size_; }
+
+private:
+    const double* data_;
+    size_t size_;
+};
+
+/**
+ * Process-wide cache of Savitzky-Golay coefficients, for programs which
+ * create many filters with the same design.
+ *
+ * The coefficients for a set of design parameters are computed with
+ * SavitzkyGolayFilter on the first request and never change or move
+ * afterwards, so all users share the same memory. Lookups of coefficients
+ * which are in the cache do not take a lock: the cache is an open addressing
+ * hash table of atomic pointers, which is only modified by inserting under a
+ * mutex. When the table grows it is replaced by a copy, the old tables and
+ * all entries stay alive until the end of the process.
+ *
+ * The cache has no step parameter: it stores the coefficients for a step of
+ * 1, and for derivatives the caller divides them by the step. So designs
+ * which only differ in the sample time share one entry, and a program which
+ * measures the step at runtime does not add entries for every value.
+ *
+ * @code
+ * SavitzkyGolayCoefficients c = SavitzkyGolayCache::get(0, 4, 2);
+ * double y = std::inner_product(c.begin(), c.end(), &x[k-4], 0.0);
+ * @endcode
+ */
+class SavitzkyGolayCache
+{
+public:
+    /** Coefficients for the design, with the parameters of SavitzkyGolayFilter
+     *  and a step of 1. Thread-safe.
+     *
+     *  @throw std::invalid_argument for invalid parameters
+     */
+    static SavitzkyGolayCoefficients get(int ls_point, int half_width, int poly_order, int derivative = 0);
+
+    /** Number of designs in the cache. */
+    static size_t size();
+};
+}
+
+#endif
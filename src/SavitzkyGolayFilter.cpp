@@ -5,38 +5,55 @@ namespace numeric
 SavitzkyGolayFilter::SavitzkyGolayFilter(std::vector<double>& result, int ls_point, int half_width, int poly_order, int derivative, double step)
 {
     checkParameters(ls_point, half_width, poly_order, derivative, step);
+    std::vector<double> gram;
+    gramPolynomials(gram, half_width, poly_order, derivative);
     result.clear();
     for (int i = -half_width; i <= half_width; i++)
-        result.push_back( weight(i, ls_point, half_width, poly_order, derivative));
+        result.push_back( weight(gram, i, ls_point, half_width, poly_order, derivative));
     if(derivative && step != 1)
         std::transform(result.begin(), result.end(), result.begin(), std::bind2nd(std::divides<double>(), step));
 }
 SavitzkyGolayFilter::~SavitzkyGolayFilter(){}
 
-double SavitzkyGolayFilter::weight(int i, int t, int m, int n, int s)
+double SavitzkyGolayFilter::weight(const std::vector<double>& gram, int i, int t, int m, int n, int s)
 {
+    const int points = 2*m+1;
     double sum = 0;
     for(int k=0; k<=n; k++)
         sum += ( (double)(2*k+1)*generalizedFactorial(2*m, k) / generalizedFactorial((2*m+k+1),(k+1)) *
-                gramPolynomial(i, m, k, 0) * gramPolynomial(t, m, k, s) );
+                gram[k*points + i+m] * gram[(s*(n+1) + k)*points + t+m] );
     return sum;
 }
 
-double SavitzkyGolayFilter::gramPolynomial(int i, int m, int k, int s)
+void SavitzkyGolayFilter::gramPolynomials(std::vector<double>& gram, int m, int n, int s)
 {
-    double gram_poly = 0;
-    if (k > 0)
+    // bottom-up evaluation of the recurrence
+    //   F(i, k, d) = k1 * (i*F(i, k-1, d) + d*F(i, k-1, d-1)) - k2 * F(i, k-2, d)
+    // with F(i, 0, 0) = 1 and F(i, 0, d) = 0 for d > 0
+    const int points = 2*m+1;
+    gram.assign((s+1)*(n+1)*points, 0.0);
+    for (int d = 0; d <= s; d++)
     {
-        double gp1 = i*gramPolynomial(i, m, k-1, s) + s*gramPolynomial(i, m, k-1, s-1);
-        double gp2 = gramPolynomial(i, m, (k-2), s);
-        double k1 = (double)(4*k-2) / (k*(2*m-k+1));
-        double k2 = (double)((k-1)*(2*m+k)) / (k*(2*m-k+1));
-
-        gram_poly = k1*gp1 - k2*gp2;
+        double* cur = &gram[d*(n+1)*points];
+        const double* lower = d ? &gram[(d-1)*(n+1)*points] : 0;
+        for (int k = 0; k <= n; k++)
+        {
+            if (k == 0)
+            {
+                if (d == 0)
+                    std::fill(cur, cur + points, 1.0);
+                continue;
+            }
+            double k1 = (double)(4*k-2) / (k*(2*m-k+1));
+            double k2 = (double)((k-1)*(2*m+k)) / (k*(2*m-k+1));
+            for (int i = -m; i <= m; i++)
+            {
+                double gp1 = i*cur[(k-1)*points + i+m] + (d ? d*lower[(k-1)*points + i+m] : 0);
+                double gp2 = k >= 2 ? cur[(k-2)*points + i+m] : 0;
+                cur[k*points + i+m] = k1*gp1 - k2*gp2;
+            }
+        }
     }
-    else if (k==0 && s==0)
-        gram_poly = 1;
-    return gram_poly;
 }
 
 double SavitzkyGolayFilter::generalizedFactorial(int a, int b)
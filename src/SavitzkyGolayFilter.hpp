@@ -37,6 +37,7 @@ private:
 
     /** Calculates the weight of the i'th data point for the t'th least-Square point of the s'th derivative, over 2m+1 points, order n
      *
+     *  @param gram table of the gram polynomials, from gramPolynomials()
      *  @param i data point, between [-m, m]
      *  @param t Least-Square point, between [-m, m]
      *  @param m half width
@@ -44,17 +45,17 @@ private:
      *  @param s derivative
      *  @return weight
      */
-    double weight(int i, int t, int m, int n, int s);
+    double weight(const std::vector<double>& gram, int i, int t, int m, int n, int s);
 
-    /** Calculates the Gram Polynomial (s=0), or its s'th derivative evaluated at i, order k, over 2m+1 points
+    /** Calculates the Gram Polynomials of order 0 to n and their derivatives 0 to s, evaluated at all
+     *  2m+1 points. Uses the recurrence bottom-up, so each value is computed once.
      *
-     *  @param i data point
+     *  @param gram table, the value for point i, order k and derivative d is at (d*(n+1) + k)*(2m+1) + i+m
      *  @param m half width
-     *  @param k order
-     *  @param s derivative
-     *  @return gram polynomial, or it's derivative
+     *  @param n highest order
+     *  @param s highest derivative
      */
-    double gramPolynomial(int i, int m, int k, int s);
+    void gramPolynomials(std::vector<double>& gram, int m, int n, int s);
 
     /** Calculates the generalized factorial (a)(a-1)...(a-b+1)
      *
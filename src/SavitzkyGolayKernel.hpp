@@ -0,0 +1,114 @@
+#ifndef __NUMERIC_SAVITZKY_GOLAY_KERNEL_HPP__
+#define __NUMERIC_SAVITZKY_GOLAY_KERNEL_HPP__
+
+#include <array>
+#include <stdexcept>
+#include <stdlib.h>
+
+namespace numeric
+{
+/**
+ * Compile-time form of the Savitzky-Golay coefficients of
+ * SavitzkyGolayFilter, for filters with a fixed design. The functions are
+ * C++11 constexpr, so they are written recursively, and evaluate the same
+ * expressions in the same order as SavitzkyGolayFilter, which gives the same
+ * coefficients.
+ */
+namespace savitzky_golay
+{
+    /** (a)(a-1)...(a-b+1), multiplied up from the lowest factor */
+    constexpr double factorialProduct(double acc, int i, int a)
+    {
+        return i > a ? acc : factorialProduct(acc * i, i + 1, a);
+    }
+
+    constexpr double generalizedFactorial(int a, int b)
+    {
+        return (b > 0 && a > b) ? factorialProduct(1, a - b + 1, a) : 1;
+    }
+
+    constexpr double gramPolynomial(int i, int m, int k, int s);
+
+    /** iterates the recurrence from order j to k, f1 and f2 are the values for j-1 and j-2 */
+    constexpr double gramRecurrence(int i, int m, int j, int k, int s, double f1, double f2)
+    {
+        return j > k ? f1
+            : gramRecurrence(i, m, j + 1, k, s,
+                    (double)(4*j-2) / (j*(2*m-j+1)) * (i*f1 + (s ? s*gramPolynomial(i, m, j-1, s-1) : 0.0))
+                    - (double)((j-1)*(2*m+j)) / (j*(2*m-j+1)) * f2,
+                    f1);
+    }
+
+    /** Gram Polynomial (s=0), or its s'th derivative evaluated at i, order k, over 2m+1 points */
+    constexpr double gramPolynomial(int i, int m, int k, int s)
+    {
+        return gramRecurrence(i, m, 1, k, s, s == 0 ? 1.0 : 0.0, 0.0);
+    }
+
+    constexpr double weightSum(double sum, int k, int i, int t, int m, int n, int s)
+    {
+        return k > n ? sum
+            : weightSum(sum + (double)(2*k+1)*generalizedFactorial(2*m, k) / generalizedFactorial((2*m+k+1),(k+1)) *
+                    gramPolynomial(i, m, k, 0) * gramPolynomial(t, m, k, s),
+                    k + 1, i, t, m, n, s);
+    }
+
+    /** weight of the i'th data point for the t'th least-Square point of the s'th derivative, over 2m+1 points, order n */
+    constexpr double weight(int i, int t, int m, int n, int s, double step)
+    {
+        return (s && step != 1) ? weightSum(0, 0, i, t, m, n, s) / step : weightSum(0, 0, i, t, m, n, s);
+    }
+
+    template <int... I> struct Indices {};
+    template <int N, int... I> struct MakeIndices : MakeIndices<N-1, N-1, I...> {};
+    template <int... I> struct MakeIndices<0, I...> { typedef Indices<I...> type; };
+
+    template <int HalfWidth, int PolyOrder, int Derivative, int... I>
+    constexpr std::array<double, sizeof...(I)> kernel(int ls_point, double step, Indices<I...>)
+    {
+        return {{ weight(I - HalfWidth, ls_point, HalfWidth, PolyOrder, Derivative, step)... }};
+    }
+}
+
+/** Savitzky-Golay coefficients as constant expression, the same as the
+ *  result of SavitzkyGolayFilter.
+ *
+ *  @code
+ *  // 7 point quadratic smoother, computed by the compiler
+ *  constexpr std::array<double, 7> smooth = savitzkyGolayKernel<3, 2>();
+ *  double y = applyKernel(smooth, &x[k-3]);
+ *  @endcode
+ *
+ *  @tparam HalfWidth. Number of points used 2*HalfWidth+1
+ *  @tparam PolyOrder, polynomial order
+ *  @tparam Derivative. 0 = smooth
+ *  @param ls_point, Least-Square point, between [-HalfWidth, HalfWidth]
+ *  @param step. Necessary in case of derivatives, when the coefficients need to be divided by the step.
+ */
+template <int HalfWidth, int PolyOrder, int Derivative = 0>
+constexpr std::array<double, 2*HalfWidth+1> savitzkyGolayKernel(int ls_point = 0, double step = 1)
+{
+    static_assert(HalfWidth > 0 && PolyOrder >= 0 && Derivative >= 0, "numeric::savitzkyGolayKernel: negative parameters.");
+    static_assert(PolyOrder <= 2*HalfWidth, "numeric::savitzkyGolayKernel: polynomial order bigger than number of samples.");
+    return (ls_point < -HalfWidth || ls_point > HalfWidth)
+        ? throw std::invalid_argument("numeric::savitzkyGolayKernel: point outside width.")
+        : !(step > 0)
+        ? throw std::invalid_argument("numeric::savitzkyGolayKernel: negative or zero step.")
+        : savitzky_golay::kernel<HalfWidth, PolyOrder, Derivative>(ls_point, step,
+                typename savitzky_golay::MakeIndices<2*HalfWidth+1>::type());
+}
+
+/** Applies a kernel to the window starting at data. The number of taps is
+ *  known at compile time, so the compiler can unroll the loop.
+ */
+template <size_t N>
+inline double applyKernel(const std::array<double, N>& kernel, const double* data)
+{
+    double sum = 0;
+    for (size_t i = 0; i < N; i++)
+        sum += kernel[i] * data[i];
+    return sum;
+}
+}
+
+#endif
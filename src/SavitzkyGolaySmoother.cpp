@@ -0,0 +1,89 @@
+#include "SavitzkyGolaySmoother.hpp"
+#include "SavitzkyGolayCache.hpp"
+#include <stdexcept>
+
+namespace numeric
+{
+SavitzkyGolaySmoother::SavitzkyGolaySmoother(int half_width, int poly_order, int derivative, double step)
+    : half_width_(half_width), window_(2*half_width+1)
+{
+    // the other parameters are checked by SavitzkyGolayFilter, the cache
+    // holds the coefficients for a step of 1, scaled here like
+    // SavitzkyGolayFilter does
+    if (step <= 0)
+        throw std::invalid_argument("numeric::SavitzkyGolaySmoother: negative or zero step.");
+    for (int t = -half_width; t <= half_width; t++)
+    {
+        SavitzkyGolayCoefficients coeff = SavitzkyGolayCache::get(t, half_width, poly_order, derivative);
+        if (t == -half_width)
+            kernels_.resize(window_, window_);
+        kernels_.col(t + half_width) = Eigen::Map<const Eigen::VectorXd>(coeff.data(), window_);
+    }
+    if (derivative && step != 1)
+        kernels_ /= step;
+    ring_.resize(2*window_);
+    reset();
+}
+
+size_t SavitzkyGolaySmoother::update(double value, double* output)
+{
+    ring_[pos_] = ring_[pos_ + window_] = value;
+    pos_ = (pos_ + 1) % window_;
+    ++count_;
+
+    if (count_ < (size_t)window_)
+        return 0;
+
+    const double* window = &ring_[pos_];
+    if (count_ == (size_t)window_)
+    {
+        // the first samples are only covered by the first window
+        for (int t = -half_width_; t <= 0; t++)
+            output[t + half_width_] = dot(t, window);
+        return half_width_ + 1;
+    }
+    output[0] = dot(0, window);
+    return 1;
+}
+
+size_t SavitzkyGolaySmoother::process(const double* input, size_t count, double* output)
+{
+    size_t written = 0;
+    for (size_t i = 0; i < count; i++)
+        written += update(input[i], output + written);
+    return written;
+}
+
+size_t SavitzkyGolaySmoother::flush(double* output)
+{
+    size_t written = 0;
+    if (count_ >= (size_t)window_)
+    {
+        const double* window = &ring_[pos_];
+        for (int t = 1; t <= half_width_; t++)
+            output[written++] = dot(t, window);
+    }
+    reset();
+    return written;
+}
+
+void SavitzkyGolaySmoother::reset()
+{
+    pos_ = 0;
+    count_ = 0;
+}
+
+void SavitzkyGolaySmoother::apply(const double* input, size_t count, double* output) const
+{
+    if (count < (size_t)window_)
+        throw std::invalid_argument("numeric::SavitzkyGolaySmoother: signal shorter than the window.");
+
+    for (int t = -half_width_; t < 0; t++)
+        output[t + half_width_] = dot(t, input);
+    for (size_t k = half_width_; k < count - half_width_; k++)
+        output[k] = dot(0, input + k - half_width_);
+    const double* last = input + count - window_;
+    for (int t = 1; t <= half_width_; t++)
+        output[count - 1 - half_width_ + t] = dot(t, last);
+}
+}
@@ -0,0 +1,111 @@
+#ifndef __NUMERIC_SAVITZKY_GOLAY_SMOOTHER_HPP__
+#define __NUMERIC_SAVITZKY_GOLAY_SMOOTHER_HPP__
+
+#include <vector>
+#include <stdlib.h>
+#include <Eigen/Core>
+
+namespace numeric
+{
+/**
+ * Applies a Savitzky-Golay filter to a signal, either streaming sample by
+ * sample or to a whole array.
+ *
+ * The kernels for all least-squares points in the window are taken from the
+ * SavitzkyGolayCache and scaled by the step, so differentiators for
+ * different steps do not add entries to the cache. Samples which are at
+ * least half_width away from both ends of the signal use the centered
+ * kernel, the first and last half_width samples use the off-center kernels
+ * of the first and last window. So every input sample gives one output
+ * sample, without padding.
+ *
+ * When streaming, the last window is kept in a ring buffer which stores
+ * every sample twice, so the window is always contiguous in memory and the
+ * kernel is applied with a vectorized dot product. The output lags behind
+ * the input by half_width samples, the outputs for the last samples are
+ * written by flush().
+ *
+ * @code
+ * SavitzkyGolaySmoother sg(4, 2);
+ * std::vector<double> out(sg.maxOutputs(count));
+ * size_t n = sg.process(&in[0], count, &out[0]);
+ * n += sg.flush(&out[n]);
+ * @endcode
+ */
+class SavitzkyGolaySmoother
+{
+public:
+    /**
+     *  @param half_width. Number of points used 2*half_width+1
+     *  @param poly_order, polynomial order
+     *  @param derivative. 0 = smooth
+     *  @param step. Step between the samples, for derivatives.
+     */
+    SavitzkyGolaySmoother(int half_width, int poly_order, int derivative = 0, double step = 1);
+
+    /** Adds a sample and writes the outputs which became available.
+     *
+     *  @param value, new sample
+     *  @param output, space for at least half_width+1 values
+     *  @return number of outputs written. 0 until the first window is
+     *  complete, half_width+1 for the first window and 1 afterwards.
+     */
+    size_t update(double value, double* output);
+
+    /** Same as calling update() for each of the samples.
+     *
+     *  @param output, space for maxOutputs(count) values
+     *  @return number of outputs written
+     */
+    size_t process(const double* input, size_t count, double* output);
+
+    /** Writes the outputs for the last half_width samples, using the
+     *  off-center kernels, and resets the stream. Nothing is written if the
+     *  stream has fewer samples than a window.
+     *
+     *  @param output, space for half_width values
+     *  @return number of outputs written
+     */
+    size_t flush(double* output);
+
+    /** Discards the buffered samples. */
+    void reset();
+
+    /** Filters a whole signal, including the edges.
+     *
+     *  @param input, count samples, at least windowSize()
+     *  @param output, space for count values, must not overlap the input
+     */
+    void apply(const double* input, size_t count, double* output) const;
+
+    /** Largest number of outputs process() can write for count samples. */
+    size_t maxOutputs(size_t count) const { return count + half_width_; }
+
+    /** Number of samples the output lags behind the input. */
+    int delay() const { return half_width_; }
+
+    int windowSize() const { return window_; }
+
+    /** Kernel for the least-squares point ls_point in [-half_width, half_width]. */
+    Eigen::VectorXd kernel(int ls_point) const { return kernels_.col(ls_point + half_width_); }
+
+private:
+    int half_width_;
+    int window_;
+
+    /** column t + half_width is the kernel for the least-squares point t */
+    Eigen::MatrixXd kernels_;
+
+    /** two copies of the window, the current window starts at pos_ */
+    std::vector<double> ring_;
+    size_t pos_;
+    size_t count_;
+
+    double dot(int ls_point, const double* window) const
+    {
+        return kernels_.col(ls_point + half_width_).dot(Eigen::Map<const Eigen::VectorXd>(window, window_));
+    }
+};
+}
+
+#endif
@@ -0,0 +1,393 @@
+#include "SosFilter.hpp"
+#include <algorithm>
+#include <math.h>
+#include <stdexcept>
+
+namespace numeric
+{
+
+namespace
+{
+
+typedef std::complex<double> Complex;
+
+enum BandType { LOW_PASS, HIGH_PASS, BAND_PASS };
+
+/** Poles of the analog Butterworth prototype with cutoff 1 rad/s. */
+std::vector<Complex> butterworthPrototype(int order)
+{
+    std::vector<Complex> poles;
+    for (int k = 0; k < order; k++)
+        poles.push_back(std::polar(1.0, M_PI * (2 * k + order + 1) / (2.0 * order)));
+    return poles;
+}
+
+/** Poles of the analog Chebyshev type I prototype with pass band edge 1 rad/s. */
+std::vector<Complex> chebyshevPrototype(int order, double epsilon)
+{
+    const double mu = asinh(1.0 / epsilon) / order;
+    std::vector<Complex> poles;
+    for (int k = 0; k < order; k++)
+    {
+        const double theta = M_PI * (2 * k + 1) / (2.0 * order);
+        poles.push_back(Complex(-sinh(mu) * sin(theta), cosh(mu) * cos(theta)));
+    }
+    return poles;
+}
+
+void checkFrequency(double frequency, double sampleTime)
+{
+    if (!(sampleTime > 0))
+        throw std::invalid_argument("numeric::SosFilter: the sample time needs to be positive.");
+    if (!(frequency > 0) || !(frequency < 0.5 / sampleTime))
+        throw std::invalid_argument("numeric::SosFilter: the cutoff frequency needs to be between 0 and the Nyquist frequency.");
+}
+
+/**
+ * Transforms the prototype to the requested band, maps it to discrete time
+ * with the bilinear transform and splits it into sections.
+ *
+ * @param gain - gain of the prototype at 0 rad/s, the result is scaled to it
+ *		 at the reference frequency of the band
+ */
+std::vector<Biquad> design(const std::vector<Complex>& prototype, double gain,
+        BandType band, double low, double high, double sampleTime)
+{
+    checkFrequency(low, sampleTime);
+    if (band == BAND_PASS)
+    {
+        checkFrequency(high, sampleTime);
+        if (!(low < high))
+            throw std::invalid_argument("numeric::SosFilter: the lower band edge needs to be below the upper one.");
+    }
+
+    // prewarped analog frequencies
+    const double fs2 = 2.0 / sampleTime;
+    const double w1 = fs2 * tan(M_PI * low * sampleTime);
+    const double w2 = fs2 * tan(M_PI * high * sampleTime);
+
+    std::vector<Complex> poles;
+    std::vector<double> zeros;
+    double reference = 0;
+    for (size_t i = 0; i < prototype.size(); i++)
+    {
+        const Complex& p(prototype[i]);
+        switch (band)
+        {
+        case LOW_PASS:
+            poles.push_back(p * w1);
+            // analog zeros at infinity
+            zeros.push_back(-1);
+            break;
+        case HIGH_PASS:
+            poles.push_back(w1 / p);
+            // analog zeros at 0
+            zeros.push_back(1);
+            reference = M_PI;
+            break;
+        case BAND_PASS:
+        {
+            const Complex a = p * (w2 - w1) / 2.0;
+            const Complex d = sqrt(a * a - w1 * w2);
+            poles.push_back(a + d);
+            poles.push_back(a - d);
+            zeros.push_back(1);
+            zeros.push_back(-1);
+            reference = 2.0 * atan(sqrt(w1 * w2) / fs2);
+            break;
+        }
+        }
+    }
+
+    // bilinear transform, pairs of complex poles and the real poles give
+    // one section each
+    std::vector<Complex> pairs;
+    std::vector<double> reals;
+    for (size_t i = 0; i < poles.size(); i++)
+    {
+        const Complex z = (fs2 + poles[i]) / (fs2 - poles[i]);
+        if (fabs(z.imag()) <= 1e-12 * std::abs(z))
+            reals.push_back(z.real());
+        else if (z.imag() > 0)
+            pairs.push_back(z);
+    }
+    std::sort(reals.begin(), reals.end());
+
+    std::vector<Biquad> sections;
+    size_t zero = 0;
+    for (size_t i = 0; i < pairs.size(); i++)
+    {
+        const double z1 = zeros[zero++], z2 = zeros[zero++];
+        Biquad s = { 1.0, -(z1 + z2), z1 * z2, -2.0 * pairs[i].real(), std::norm(pairs[i]) };
+        sections.push_back(s);
+    }
+    for (size_t i = 0; i < reals.size(); i += 2)
+    {
+        if (i + 1 < reals.size())
+        {
+            const double z1 = zeros[zero++], z2 = zeros[zero++];
+            Biquad s = { 1.0, -(z1 + z2), z1 * z2, -(reals[i] + reals[i+1]), reals[i] * reals[i+1] };
+            sections.push_back(s);
+        }
+        else
+        {
+            Biquad s = { 1.0, -zeros[zero++], 0.0, -reals[i], 0.0 };
+            sections.push_back(s);
+        }
+    }
+
+    // scale to the prototype gain at the reference frequency, spread over
+    // all sections
+    const double scale = pow(gain / std::abs(frequencyResponse(sections, reference / (2.0 * M_PI * sampleTime), sampleTime)),
+            1.0 / sections.size());
+    for (size_t i = 0; i < sections.size(); i++)
+    {
+        sections[i].b0 *= scale;
+        sections[i].b1 *= scale;
+        sections[i].b2 *= scale;
+    }
+    return sections;
+}
+
+std::vector<Biquad> butterworth(int order, BandType band, double low, double high, double sampleTime)
+{
+    if (order < 1)
+        throw std::invalid_argument("numeric::SosFilter: the filter order needs to be at least 1.");
+    return design(butterworthPrototype(order), 1.0, band, low, high, sampleTime);
+}
+
+std::vector<Biquad> chebyshev(int order, double ripple, BandType band, double low, double high, double sampleTime)
+{
+    if (order < 1)
+        throw std::invalid_argument("numeric::SosFilter: the filter order needs to be at least 1.");
+    if (!(ripple > 0))
+        throw std::invalid_argument("numeric::SosFilter: the ripple needs to be positive.");
+    const double epsilon = sqrt(pow(10.0, ripple / 10.0) - 1.0);
+    // even orders start at the bottom of the ripple
+    const double gain = order % 2 ? 1.0 : 1.0 / sqrt(1.0 + epsilon * epsilon);
+    return design(chebyshevPrototype(order, epsilon), gain, band, low, high, sampleTime);
+}
+
+}
+
+std::vector<Biquad> matchedPoleZeroLowPass(double pole1, double pole2, double sampleTime)
+{
+    const double mappedPole1 = exp(pole1 * sampleTime);
+    const double mappedPole2 = exp(pole2 * sampleTime);
+    Biquad s = { 1 - (mappedPole1 + mappedPole2) + mappedPole1 * mappedPole2, 0.0, 0.0,
+        -(mappedPole1 + mappedPole2), mappedPole1 * mappedPole2 };
+    return std::vector<Biquad>(1, s);
+}
+
+std::vector<Biquad> butterworthLowPass(int order, double cutoff, double sampleTime)
+{
+    return butterworth(order, LOW_PASS, cutoff, cutoff, sampleTime);
+}
+
+std::vector<Biquad> butterworthHighPass(int order, double cutoff, double sampleTime)
+{
+    return butterworth(order, HIGH_PASS, cutoff, cutoff, sampleTime);
+}
+
+std::vector<Biquad> butterworthBandPass(int order, double low, double high, double sampleTime)
+{
+    return butterworth(order, BAND_PASS, low, high, sampleTime);
+}
+
+std::vector<Biquad> chebyshevLowPass(int order, double ripple, double cutoff, double sampleTime)
+{
+    return chebyshev(order, ripple, LOW_PASS, cutoff, cutoff, sampleTime);
+}
+
+std::vector<Biquad> chebyshevHighPass(int order, double ripple, double cutoff, double sampleTime)
+{
+    return chebyshev(order, ripple, HIGH_PASS, cutoff, cutoff, sampleTime);
+}
+
+std::vector<Biquad> chebyshevBandPass(int order, double ripple, double low, double high, double sampleTime)
+{
+    return chebyshev(order, ripple, BAND_PASS, low, high, sampleTime);
+}
+
+std::complex<double> frequencyResponse(const std::vector<Biquad>& sections, double frequency, double sampleTime)
+{
+    const Complex zi = std::polar(1.0, -2.0 * M_PI * frequency * sampleTime);
+    Complex h = 1.0;
+    for (size_t i = 0; i < sections.size(); i++)
+    {
+        const Biquad& s(sections[i]);
+        h *= (s.b0 + (s.b1 + s.b2 * zi) * zi) / (1.0 + (s.a1 + s.a2 * zi) * zi);
+    }
+    return h;
+}
+
+SosFilter::SosFilter(const std::vector<Biquad>& sections, int channels)
+    : sections_(sections), channels_(channels)
+{
+    if (sections.empty())
+        throw std::invalid_argument("numeric::SosFilter: need at least one section.");
+    if (channels < 1)
+        throw std::invalid_argument("numeric::SosFilter: need at least one channel.");
+    state1_ = Eigen::ArrayXXd::Zero(channels, sections.size());
+    state2_ = Eigen::ArrayXXd::Zero(channels, sections.size());
+    work_.resize(channels);
+    out_.resize(channels);
+}
+
+void SosFilter::reset()
+{
+    state1_.setZero();
+    state2_.setZero();
+}
+
+void SosFilter::setSteadyState(const base::VectorXd& value)
+{
+    if (value.size() != channels_)
+        throw std::invalid_argument("numeric::SosFilter: wrong number of channels.");
+    work_ = value.array();
+    steadyState(work_);
+}
+
+void SosFilter::steadyState(Eigen::ArrayXd& value)
+{
+    for (size_t i = 0; i < sections_.size(); i++)
+    {
+        const Biquad& s(sections_[i]);
+        const double gain = (s.b0 + s.b1 + s.b2) / (1.0 + s.a1 + s.a2);
+        out_ = gain * value;
+        state2_.col(i) = s.b2 * value - s.a2 * out_;
+        state1_.col(i) = s.b1 * value - s.a1 * out_ + state2_.col(i);
+        value.swap(out_);
+    }
+}
+
+void SosFilter::step()
+{
+    for (size_t i = 0; i < sections_.size(); i++)
+    {
+        const Biquad& s(sections_[i]);
+        out_ = s.b0 * work_ + state1_.col(i);
+        state1_.col(i) = s.b1 * work_ - s.a1 * out_ + state2_.col(i);
+        state2_.col(i) = s.b2 * work_ - s.a2 * out_;
+        work_.swap(out_);
+    }
+}
+
+double SosFilter::process(double input)
+{
+    process(&input, &input, 1);
+    return input;
+}
+
+void SosFilter::process(const double* input, double* output, size_t nSamples)
+{
+    if (channels_ != 1)
+        throw std::invalid_argument("numeric::SosFilter: the single channel API needs a filter with one channel.");
+
+    // section by section over the whole block, keeping the state in registers
+    const double* in = input;
+    for (size_t i = 0; i < sections_.size(); i++)
+    {
+        const Biquad& s(sections_[i]);
+        double s1 = state1_(0, i), s2 = state2_(0, i);
+        for (size_t k = 0; k < nSamples; k++)
+        {
+            const double x = in[k];
+            const double y = s.b0 * x + s1;
+            s1 = s.b1 * x - s.a1 * y + s2;
+            s2 = s.b2 * x - s.a2 * y;
+            output[k] = y;
+        }
+        state1_(0, i) = s1;
+        state2_(0, i) = s2;
+        in = output;
+    }
+}
+
+void SosFilter::process(const base::MatrixXd& input, base::MatrixXd& output)
+{
+    if (input.rows() != channels_)
+        throw std::invalid_argument("numeric::SosFilter: wrong number of channels.");
+
+    // no-op if both are the same matrix
+    output.resize(input.rows(), input.cols());
+
+    for (int k = 0; k < input.cols(); k++)
+    {
+        work_ = input.col(k).array();
+        step();
+        output.col(k) = work_.matrix();
+    }
+}
+
+void SosFilter::process(base::MatrixXd& signal)
+{
+    process(signal, signal);
+}
+
+void SosFilter::filtfilt(base::MatrixXd& signal, int padding)
+{
+    if (signal.rows() != channels_)
+        throw std::invalid_argument("numeric::SosFilter: wrong number of channels.");
+    filtfilt(signal.data(), signal.cols(), padding);
+}
+
+void SosFilter::filtfilt(double* signal, size_t nSamples, int padding)
+{
+    if (nSamples == 0)
+        return;
+    if (padding < 0)
+        padding = 3 * (2 * sections_.size() + 1);
+    const int pad = std::min<size_t>(padding, nSamples - 1);
+    const int n = nSamples;
+    Eigen::Map<Eigen::MatrixXd> x(signal, channels_, n);
+
+    // the end of the signal is needed for the extension after it has been
+    // overwritten, later the buffer takes the forward output of the extension
+    Eigen::ArrayXXd tail = x.rightCols(pad + 1).array();
+
+    // forward pass over the extension before the signal, the signal and the
+    // extension after it
+    work_ = 2.0 * x.col(0).array() - x.col(pad).array();
+    steadyState(work_);
+    for (int j = pad; j > 0; j--)
+    {
+        work_ = 2.0 * x.col(0).array() - x.col(j).array();
+        step();
+    }
+    for (int k = 0; k < n; k++)
+    {
+        work_ = x.col(k).array();
+        step();
+        x.col(k) = work_.matrix();
+    }
+    for (int j = 1; j <= pad; j++)
+    {
+        work_ = 2.0 * tail.col(pad) - tail.col(pad - j);
+        step();
+        tail.col(pad - j) = work_;
+    }
+
+    // backward pass, the output for the extension before the signal is not
+    // needed
+    if (pad)
+        work_ = tail.col(0);
+    else
+        work_ = x.col(n - 1).array();
+    steadyState(work_);
+    for (int j = 0; j < pad; j++)
+    {
+        work_ = tail.col(j);
+        step();
+    }
+    for (int k = n - 1; k >= 0; k--)
+    {
+        work_ = x.col(k).array();
+        step();
+        x.col(k) = work_.matrix();
+    }
+
+    reset();
+}
+
+}
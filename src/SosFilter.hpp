@@ -0,0 +1,177 @@
+#ifndef __NUMERIC_SOS_FILTER_HPP__
+#define __NUMERIC_SOS_FILTER_HPP__
+
+#include <complex>
+#include <vector>
+#include <stdlib.h>
+#include "base/Eigen.hpp"
+
+namespace numeric
+{
+
+/**
+ * Coefficients of one second order section, normalized to a0 = 1:
+ *
+ *		   b0 + b1*z^-1 + b2*z^-2
+ *	H(z) = ----------------------
+ *		   1 + a1*z^-1 + a2*z^-2
+ */
+struct Biquad
+{
+    double b0, b1, b2;
+    double a1, a2;
+};
+
+/**
+ * Second order low pass from the matched pole-zero method, as used by
+ * DiscreteFilter.
+ *
+ * @param pole1, pole2 - continuous poles, need to be less than zero
+ * @param sampleTime - sampling time in s
+ * @return a single section
+ */
+std::vector<Biquad> matchedPoleZeroLowPass(double pole1, double pole2, double sampleTime);
+
+/**
+ * Butterworth filters, designed from the analog prototype with the bilinear
+ * transform. The cutoff frequencies are prewarped, so the gain at them is
+ * -3 dB.
+ *
+ * @param order - filter order, the band pass has twice as many poles
+ * @param cutoff, low, high - cutoff frequencies in Hz, between 0 and the
+ *	Nyquist frequency 1/(2*sampleTime)
+ * @param sampleTime - sampling time in s
+ */
+std::vector<Biquad> butterworthLowPass(int order, double cutoff, double sampleTime);
+std::vector<Biquad> butterworthHighPass(int order, double cutoff, double sampleTime);
+std::vector<Biquad> butterworthBandPass(int order, double low, double high, double sampleTime);
+
+/**
+ * Chebyshev type I filters, with the given pass band ripple. The gain at the
+ * cutoff frequencies is -ripple dB, the maximum gain in the pass band is 1.
+ *
+ * @param order - filter order, the band pass has twice as many poles
+ * @param ripple - pass band ripple in dB, greater than zero
+ * @param cutoff, low, high - edge frequencies of the pass band in Hz
+ * @param sampleTime - sampling time in s
+ */
+std::vector<Biquad> chebyshevLowPass(int order, double ripple, double cutoff, double sampleTime);
+std::vector<Biquad> chebyshevHighPass(int order, double ripple, double cutoff, double sampleTime);
+std::vector<Biquad> chebyshevBandPass(int order, double ripple, double low, double high, double sampleTime);
+
+/**
+ * Complex frequency response of a cascade of sections.
+ *
+ * @param frequency - frequency in Hz
+ * @param sampleTime - sampling time in s
+ */
+std::complex<double> frequencyResponse(const std::vector<Biquad>& sections, double frequency, double sampleTime);
+
+/**
+ * @brief IIR filter as a cascade of second order sections, for any number of
+ * channels.
+ *
+ * Each section is implemented in the transposed direct form II, which needs
+ * two state values per section and channel. The state of all channels is
+ * kept in contiguous arrays per section, so the multichannel update
+ * vectorizes across the channels. The coefficients come from one of the
+ * design functions above, or any other source.
+ *
+ * @code
+ * // 4th order Butterworth, 10 Hz cutoff at 1 kHz, 6 channels
+ * SosFilter filter(butterworthLowPass(4, 10.0, 0.001), 6);
+ * filter.process(signal); // 6 x N matrix, in place
+ * @endcode
+ */
+class SosFilter
+{
+public:
+    /**
+     * @param sections - coefficients of the cascade, at least one section
+     * @param channels - number of independently filtered channels
+     */
+    SosFilter(const std::vector<Biquad>& sections, int channels = 1);
+
+    /** Sets the state of all sections to zero. */
+    void reset();
+
+    /**
+     * Sets the state to the steady state for a constant input, so filtering
+     * starts without a transient.
+     *
+     * @param value - input value of each channel, size channels()
+     */
+    void setSteadyState(const base::VectorXd& value);
+
+    /** Filters one sample of a single channel filter. */
+    double process(double input);
+
+    /**
+     * Filters a block of samples of a single channel filter.
+     *
+     * @param input - nSamples input values
+     * @param output - buffer for nSamples outputs, may be the same as input
+     */
+    void process(const double* input, double* output, size_t nSamples);
+
+    /**
+     * Filters a block of samples with the channels as rows and one sample
+     * per column.
+     *
+     * @param output - resized if needed, may be the same matrix as input
+     */
+    void process(const base::MatrixXd& input, base::MatrixXd& output);
+
+    /** Filters a channels x samples block in place. */
+    void process(base::MatrixXd& signal);
+
+    /**
+     * Zero-phase filtering of a whole recorded signal, like
+     * scipy.signal.filtfilt. The signal is filtered forward and then
+     * backward, so the phase shifts cancel and the gain is squared.
+     *
+     * To reduce the transients at the edges, the signal is extended at both
+     * ends by odd reflection about its end values, and each pass starts in
+     * the steady state for its first value. The extension is computed on the
+     * fly, only the last padding + 1 samples of the signal are buffered.
+     *
+     * Uses the filter state, which is reset afterwards.
+     *
+     * @param signal - channels x samples, replaced by the filtered signal
+     * @param padding - number of samples of the extension at each end, -1
+     *	for 3 * (2 * sections + 1). Limited to the number of samples - 1.
+     */
+    void filtfilt(base::MatrixXd& signal, int padding = -1);
+
+    /**
+     * Same as filtfilt( base::MatrixXd& ), for a signal in a buffer with
+     * channels values per sample.
+     */
+    void filtfilt(double* signal, size_t nSamples, int padding = -1);
+
+    const std::vector<Biquad>& sections() const { return sections_; }
+
+    int channels() const { return channels_; }
+
+private:
+    /** Filters the values in work_ through all sections, in place. */
+    void step();
+
+    /** Sets the steady state for the input value, overwrites value. */
+    void steadyState(Eigen::ArrayXd& value);
+
+    std::vector<Biquad> sections_;
+    int channels_;
+
+    /** transposed direct form II state, channels x sections */
+    Eigen::ArrayXXd state1_;
+    Eigen::ArrayXXd state2_;
+
+    /** intermediate signals between the sections, size channels */
+    Eigen::ArrayXd work_;
+    Eigen::ArrayXd out_;
+};
+
+}
+
+#endif
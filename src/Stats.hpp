@@ -3,6 +3,12 @@
 
 #include <Eigen/Core>
 #include <base/Eigen.hpp>
+#include <algorithm>
+#include <vector>
+#include <Eigen/StdVector>
+#include <limits>
+#include <math.h>
+#include "Parallel.hpp"
 
 namespace numeric
 {
@@ -57,20 +63,302 @@ Eigen::Matrix<_Scalar, _Rows, 1, _Options> max_el(
     return a.array().max( b.array() ).matrix();
 }
 
+/** zero with the dimensions of a, which also works for dynamic Eigen types */
+template <class T> T zero_like( T const& a ) { return Zero<T>::value(); }
+
+template <class _Scalar, int _Rows, int _Cols, int _Options, int _MaxRows, int _MaxCols>
+Eigen::Matrix<_Scalar, _Rows, _Cols, _Options, _MaxRows, _MaxCols> zero_like(
+	Eigen::Matrix<_Scalar, _Rows, _Cols, _Options, _MaxRows, _MaxCols> const& a )
+{
+    return Eigen::Matrix<_Scalar, _Rows, _Cols, _Options, _MaxRows, _MaxCols>::Zero( a.rows(), a.cols() );
+}
+
+/** zero of Square<T>::Type for samples with the dimensions of a */
+template <class T> typename Square<T>::Type square_zero_like( T const& a )
+{
+    return Zero<typename Square<T>::Type>::value();
+}
+
+template <class _Scalar, int _Rows, int _Options>
+typename Square< Eigen::Matrix<_Scalar, _Rows, 1, _Options> >::Type square_zero_like(
+	Eigen::Matrix<_Scalar, _Rows, 1, _Options> const& a )
+{
+    return Square< Eigen::Matrix<_Scalar, _Rows, 1, _Options> >::Type::Zero( a.rows(), a.rows() );
+}
+
+/**
+ * Element wise operations, so that per element moments can be computed the
+ * same way for scalars and Eigen vectors.
+ */
+template <class T>
+struct Elementwise
+{
+    static T prod( T a, T b ) { return a * b; }
+    static T quot( T a, T b ) { return a / b; }
+    static T sqrt( T a ) { return ::sqrt( a ); }
+    static T diagonal( T a ) { return a; }
+    static T constant( T const& like, double value ) { return value; }
+};
+
+template <class _Scalar, int _Rows, int _Options>
+struct Elementwise< Eigen::Matrix<_Scalar, _Rows, 1, _Options> >
+{
+    typedef Eigen::Matrix<_Scalar, _Rows, 1, _Options> T;
+    static T prod( T const& a, T const& b ) { return a.cwiseProduct( b ); }
+    static T quot( T const& a, T const& b ) { return a.cwiseQuotient( b ); }
+    static T sqrt( T const& a ) { return a.cwiseSqrt(); }
+    static T diagonal( T const& a ) { return a; }
+    template <class Derived>
+    static T diagonal( Eigen::MatrixBase<Derived> const& a ) { return a.diagonal(); }
+    static T constant( T const& like, double value ) { return T::Constant( like.rows(), value ); }
+};
+
+/**
+ * Computes min, max, weighted mean and the sum of squared deviations (M2) of
+ * a contiguous block of samples. The generic version is for scalar types and
+ * maps the block onto an Eigen array, so that the reductions are vectorized
+ * over the samples.
+ */
+template <class T>
+struct StatsBlock
+{
+    typedef typename Square<T>::Type SquareType;
+
+    static void compute( const T* data, size_t count, const double* weights,
+	    T& min, T& max, T& mean, SquareType& M2, double& sum_weight )
+    {
+	typedef Eigen::Array<T, Eigen::Dynamic, 1> Array;
+	Eigen::Map<const Array> x( data, count );
+
+	min = x.minCoeff();
+	max = x.maxCoeff();
+	if( weights )
+	{
+	    Eigen::Map<const Eigen::ArrayXd> w( weights, count );
+	    sum_weight = w.sum();
+	    double m = (x.template cast<double>() * w).sum() / sum_weight;
+	    M2 = (w * (x.template cast<double>() - m).square()).sum();
+	    mean = m;
+	}
+	else
+	{
+	    sum_weight = count;
+	    mean = x.sum() / T(count);
+	    M2 = (x - mean).square().sum();
+	}
+    }
+};
+
+/**
+ * Block kernel for Eigen vectors. Samples are not necessarily contiguous
+ * (e.g. base::VectorXd), so the block is processed sample by sample, but
+ * without temporaries and with vectorized rank one updates for M2.
+ */
+template <class _Scalar, int _Rows, int _Options>
+struct StatsBlock< Eigen::Matrix<_Scalar, _Rows, 1, _Options> >
+{
+    typedef Eigen::Matrix<_Scalar, _Rows, 1, _Options> T;
+    typedef typename Square<T>::Type SquareType;
+
+    static void compute( const T* data, size_t count, const double* weights,
+	    T& min, T& max, T& mean, SquareType& M2, double& sum_weight )
+    {
+	min = data[0];
+	max = data[0];
+	mean = data[0] * _Scalar( weights ? weights[0] : 1.0 );
+	sum_weight = weights ? weights[0] : 1.0;
+	for( size_t i = 1; i < count; i++ )
+	{
+	    double w = weights ? weights[i] : 1.0;
+	    min = min.cwiseMin( data[i] );
+	    max = max.cwiseMax( data[i] );
+	    mean += data[i] * _Scalar( w );
+	    sum_weight += w;
+	}
+	mean /= _Scalar( sum_weight );
+
+	T delta = data[0] - mean;
+	M2.noalias() = ( delta * _Scalar( weights ? weights[0] : 1.0 ) ) * delta.transpose();
+	for( size_t i = 1; i < count; i++ )
+	{
+	    delta = data[i] - mean;
+	    M2.noalias() += ( delta * _Scalar( weights ? weights[i] : 1.0 ) ) * delta.transpose();
+	}
+    }
+};
+
+/**
+ * Moment policies for Stats, which select the moments that are tracked in
+ * addition to min, max and mean. Unused state is stripped at compile time.
+ */
+/** only the mean, var() and stdev() are not available */
+struct MeanOnly {};
+/** mean and per element variance, O(n) instead of O(n^2) for n dimensional
+ * vectors. var() returns a vector instead of a matrix */
+struct DiagonalVariance {};
+/** mean and full (co)variance, the default */
+struct FullCovariance {};
+/** in addition to FullCovariance the per element 3rd and 4th central
+ * moments, which give skewness and kurtosis */
+struct HigherMoments {};
+
+template <class T, class Moments> struct StatsMoments;
+
+template <class T>
+struct StatsMoments<T, MeanOnly>
+{
+    typedef void VarType;
+
+    void init( T const& data ) {}
+    void update( T const& delta, T const& R, double w_a, double w_b ) {}
+    void merge( StatsMoments const& b, T const& delta, double w_a, double w_b ) {}
+};
+
+/** Per element sum of squared deviations, see the FullCovariance version */
+template <class T>
+struct StatsMoments<T, DiagonalVariance>
+{
+    typedef T VarType;
+    typedef Elementwise<T> E;
+
+    VarType M2;
+
+    void init( T const& data )
+    {
+	M2 = zero_like( data );
+    }
+
+    void update( T const& delta, T const& R, double w_a, double w_b )
+    {
+	M2 = M2 + E::prod( delta, R ) * w_a;
+    }
+
+    void merge( StatsMoments const& b, T const& delta, double w_a, double w_b )
+    {
+	M2 = M2 + b.M2 + E::prod( delta, delta ) * (w_a * w_b / (w_a + w_b));
+    }
+};
+
+/**
+ * Sum of squared deviations M2 of the samples.
+ *
+ * update() adds a single sample with the weighted West update, merge()
+ * combines the moments of two sets of samples with the pairwise formula of
+ * T. F. Chan, G. H. Golub, R. J. LeVeque (1979):
+ * Updating Formulae and a Pairwise Algorithm for Computing Sample Variances
+ *
+ * In both cases delta is the difference of the new mean (or sample) to the
+ * current mean, w_a the current weight and w_b the added weight.
+ */
+template <class T>
+struct StatsMoments<T, FullCovariance>
+{
+    typedef typename Square<T>::Type VarType;
+
+    VarType M2;
+
+    void init( T const& data )
+    {
+	M2 = square_zero_like( data );
+    }
+
+    void update( T const& delta, T const& R, double w_a, double w_b )
+    {
+	M2 = M2 + w_a * Square<T>::value( delta, R );
+    }
+
+    void merge( StatsMoments const& b, T const& delta, double w_a, double w_b )
+    {
+	M2 = M2 + b.M2 + (w_a * w_b / (w_a + w_b)) * Square<T>::value( delta );
+    }
+};
+
+/**
+ * Per element 3rd and 4th central moments on top of the covariance, using
+ * the numerically stable single pass and pairwise formulas of
+ * P. Pebay (2008): Formulas for Robust, One-Pass Parallel Computation of
+ * Covariances and Arbitrary-Order Statistical Moments
+ */
+template <class T>
+struct StatsMoments<T, HigherMoments> : public StatsMoments<T, FullCovariance>
+{
+    typedef StatsMoments<T, FullCovariance> Base;
+    typedef Elementwise<T> E;
+
+    T M3;
+    T M4;
+
+    void init( T const& data )
+    {
+	Base::init( data );
+	M3 = zero_like( data );
+	M4 = zero_like( data );
+    }
+
+    void update( T const& delta, T const& R, double w_a, double w_b )
+    {
+	// merge() with a single sample, for which M2, M3 and M4 are zero
+	const double n = w_a + w_b;
+	const T M2 = E::diagonal( this->M2 );
+	const T d2 = E::prod( delta, delta );
+	M4 = M4 + E::prod( d2, d2 ) * (w_a * w_b * (w_a * w_a - w_a * w_b + w_b * w_b) / (n * n * n))
+	    + E::prod( d2, M2 ) * (6.0 * w_b * w_b / (n * n))
+	    - E::prod( delta, M3 ) * (4.0 * w_b / n);
+	M3 = M3 + E::prod( d2, delta ) * (w_a * w_b * (w_a - w_b) / (n * n))
+	    - E::prod( delta, M2 ) * (3.0 * w_b / n);
+	Base::update( delta, R, w_a, w_b );
+    }
+
+    void merge( StatsMoments const& b, T const& delta, double w_a, double w_b )
+    {
+	const double n = w_a + w_b;
+	const T M2a = E::diagonal( this->M2 );
+	const T M2b = E::diagonal( b.M2 );
+	const T d2 = E::prod( delta, delta );
+	M4 = M4 + b.M4 + E::prod( d2, d2 ) * (w_a * w_b * (w_a * w_a - w_a * w_b + w_b * w_b) / (n * n * n))
+	    + E::prod( d2, T( M2a * (w_b * w_b) + M2b * (w_a * w_a) ) ) * (6.0 / (n * n))
+	    + E::prod( delta, T( b.M3 * w_a - M3 * w_b ) ) * (4.0 / n);
+	M3 = M3 + b.M3 + E::prod( d2, delta ) * (w_a * w_b * (w_a - w_b) / (n * n))
+	    + E::prod( delta, T( M2b * w_a - M2a * w_b ) ) * (3.0 / n);
+	Base::merge( b, delta, w_a, w_b );
+    }
+
+    T skewness( double sum_weight ) const
+    {
+	const T M2 = E::diagonal( this->M2 );
+	return E::quot( M3 * sqrt( sum_weight ), E::prod( M2, E::sqrt( M2 ) ) );
+    }
+
+    T kurtosis( double sum_weight ) const
+    {
+	const T M2 = E::diagonal( this->M2 );
+	return E::quot( M4 * sum_weight, E::prod( M2, M2 ) );
+    }
+};
+
 /**
  * Small helper class, which performs simple statistics
  * on a stream of values. Internally only commulative data
  * is stored, regardless on how many times you call update()
+ *
+ * The Moments policy selects which moments are tracked, see MeanOnly,
+ * DiagonalVariance, FullCovariance (default) and HigherMoments. Policies
+ * with less moments have a smaller state and a cheaper update.
+ *
+ * @code
+ * Stats<Eigen::Matrix<double, 100, 1>, DiagonalVariance> s;
+ * @endcode
  */
-template <class T>
+template <class T, class Moments = FullCovariance>
 class Stats
 {
-    typedef typename Square<T>::Type SquareType;
+    typedef StatsMoments<T, Moments> MomentsType;
+    typedef typename MomentsType::VarType VarType;
 
     T min_;
     T max_;
 
-    SquareType M2_;
+    MomentsType moments_;
     T mean_;
     double sum_weight_;
     size_t n_;
@@ -79,19 +367,56 @@ class Stats
 
     void init( T const& data);
 
+    /** Computes the statistics of a block of samples, replacing the current state */
+    void updateBlock( const T* data, size_t count, const double* weights, FullCovariance );
+    template <class Policy>
+    void updateBlock( const T* data, size_t count, const double* weights, Policy );
+
 public:
     Stats();
     void update( T const& data, double weight = 1.0 );
+
+    /**
+     * Updates the statistics with a whole batch of samples. The batch is
+     * processed in blocks, for each block min, max, mean and M2 are computed
+     * with vectorized kernels and then merged into the running state. Only
+     * the FullCovariance policy has a dedicated kernel, other policies update
+     * the block sample by sample. The result is the same (up to floating point rounding) as calling
+     * update() for each sample.
+     *
+     * @param data pointer to the first sample
+     * @param count number of samples
+     * @param weights optional pointer to count weights, 1.0 is used if not given
+     */
+    void updateBatch( const T* data, size_t count, const double* weights = nullptr );
+
+    /**
+     * Merges the statistics of another accumulator into this one, using the
+     * pairwise update formula of Chan et al. The result is the same as if
+     * all samples of other had been passed to update() of this object, which
+     * allows to accumulate partial results in parallel and reduce them
+     * afterwards. The ddof setting of this object is kept.
+     */
+    void merge( Stats<T, Moments> const& other );
+
     void clear();
 
     T min() const;
     T max() const;
     T mean() const;
-    SquareType var() const;
+    VarType var() const;
     T stdev() const;
     double sumWeights() const;
     size_t n() const;
 
+    /** Skewness (per element for vectors), only available with the
+     * HigherMoments policy. */
+    T skewness() const;
+
+    /** Excess kurtosis (per element for vectors), that is 0 for a normal
+     * distribution. Only available with the HigherMoments policy. */
+    T kurtosis() const;
+
     /** Sets the delta for degrees of freedom, that is used to correct variance estimates.
      *
      *      var = 1 / (N-ddof) * sum(x_i - mean)^2
@@ -101,42 +426,30 @@ public:
     void setDDof(double new_ddof) { ddof_ = new_ddof; }
 };
 
-template <class T>
-Stats<T>::Stats()
+template <class T, class Moments>
+Stats<T, Moments>::Stats()
 {
     clear();
     ddof_ = 0.0;
 }
 
-template <class T>
-void Stats<T>::clear() {
+template <class T, class Moments>
+void Stats<T, Moments>::clear() {
     n_ = 0;
 }
 
-template <class T>
-void Stats<T>::init( T const& data ) {
+template <class T, class Moments>
+void Stats<T, Moments>::init( T const& data ) {
 
         sum_weight_ = 0.0;
         min_ = data;
         max_ = data;
-        M2_ = Zero<SquareType>::value();
-        mean_ = Zero<T>::value();
-}
-
-template <>
-inline void Stats<base::VectorXd>::init( base::VectorXd const& data ) {
-
-    int rows = data.rows();
-
-    sum_weight_ = 0.0;
-    min_ = data;
-    max_ = data;
-    M2_ = base::MatrixXd::Zero(rows,rows);
-    mean_ = base::VectorXd::Zero(rows);
+        moments_.init( data );
+        mean_ = zero_like( data );
 }
 
-template <class T>
-void Stats<T>::update( T const& data, double weight )
+template <class T, class Moments>
+void Stats<T, Moments>::update( T const& data, double weight )
 {
     if( !n_ )
     {
@@ -159,67 +472,186 @@ void Stats<T>::update( T const& data, double weight )
     T delta = data - mean_;
     T R = delta * weight / temp;
     mean_ = mean_ + R;
-    M2_ = M2_ + sum_weight_ * Square<T>::value( delta, R );
+    moments_.update( delta, R, sum_weight_, weight );
     sum_weight_ = temp;
 
     n_++;
 }
 
-template <class T>
-double Stats<T>::sumWeights() const
+template <class T, class Moments>
+void Stats<T, Moments>::updateBatch( const T* data, size_t count, const double* weights )
+{
+    // small enough that the two passes over a block stay in cache
+    static const size_t block_size = 4096;
+
+    for( size_t i = 0; i < count; i += block_size )
+    {
+	size_t len = std::min( block_size, count - i );
+	Stats<T, Moments> block;
+	block.updateBlock( data + i, len, weights ? weights + i : nullptr, Moments() );
+	merge( block );
+    }
+}
+
+template <class T, class Moments>
+void Stats<T, Moments>::updateBlock( const T* data, size_t count, const double* weights, FullCovariance )
+{
+    StatsBlock<T>::compute( data, count, weights, min_, max_, mean_, moments_.M2, sum_weight_ );
+    n_ = count;
+}
+
+template <class T, class Moments>
+template <class Policy>
+void Stats<T, Moments>::updateBlock( const T* data, size_t count, const double* weights, Policy )
+{
+    // no dedicated kernel for this policy
+    for( size_t i = 0; i < count; i++ )
+	update( data[i], weights ? weights[i] : 1.0 );
+}
+
+template <class T, class Moments>
+void Stats<T, Moments>::merge( Stats<T, Moments> const& other )
+{
+    if( !other.n_ )
+	return;
+
+    if( !n_ )
+    {
+	min_ = other.min_;
+	max_ = other.max_;
+	mean_ = other.mean_;
+	moments_ = other.moments_;
+	sum_weight_ = other.sum_weight_;
+	n_ = other.n_;
+	return;
+    }
+
+    double temp = sum_weight_ + other.sum_weight_;
+    T delta = other.mean_ - mean_;
+    min_ = numeric::min_el(min_, other.min_);
+    max_ = numeric::max_el(max_, other.max_);
+    moments_.merge( other.moments_, delta, sum_weight_, other.sum_weight_ );
+    mean_ = mean_ + delta * (other.sum_weight_ / temp);
+    sum_weight_ = temp;
+    n_ += other.n_;
+}
+
+template <class T, class Moments>
+double Stats<T, Moments>::sumWeights() const
 {
     return sum_weight_;
 }
 
-template <class T>
-T Stats<T>::mean() const
+template <class T, class Moments>
+T Stats<T, Moments>::mean() const
 {
     return mean_;
 }
 
-template <class T>
-inline typename Stats<T>::SquareType  Stats<T>::var() const
+template <class T, class Moments>
+inline typename Stats<T, Moments>::VarType Stats<T, Moments>::var() const
 {
-    return (sum_weight_ > 0.0 ) ? SquareType(M2_ / (sum_weight_ - ddof_)) : Zero<SquareType>::value();
+    return (sum_weight_ > 0.0 ) ? VarType(moments_.M2 / (sum_weight_ - ddof_)) : zero_like(moments_.M2);
 }
 
-template <>
-inline Stats<base::VectorXd>::SquareType Stats<base::VectorXd>::var() const
+template <class T, class Moments>
+T Stats<T, Moments>::stdev() const
 {
-    return ( sum_weight_ > 0.0 ) ? SquareType(M2_ / (sum_weight_ - ddof_)) :
-        base::MatrixXd::Zero(M2_.rows(),M2_.cols());
+    return Elementwise<T>::sqrt( Elementwise<T>::diagonal( var() ) );
 }
 
-template <class T>
-T Stats<T>::stdev() const
+template <class T, class Moments>
+T Stats<T, Moments>::skewness() const
 {
-    return sqrt( var() );
+    return moments_.skewness( sum_weight_ );
 }
 
-template <>
-inline base::VectorXd Stats<base::VectorXd>::stdev() const
+template <class T, class Moments>
+T Stats<T, Moments>::kurtosis() const
 {
-    return var().diagonal().array().sqrt();
+    return moments_.kurtosis( sum_weight_ ) - Elementwise<T>::constant( mean_, 3.0 );
 }
 
-template <class T>
-T Stats<T>::min() const
+template <class T, class Moments>
+T Stats<T, Moments>::min() const
 {
     return min_;
 }
 
-template <class T>
-T Stats<T>::max() const
+template <class T, class Moments>
+T Stats<T, Moments>::max() const
 {
     return max_;
 }
 
-template <class T>
-size_t Stats<T>::n() const
+template <class T, class Moments>
+size_t Stats<T, Moments>::n() const
 {
     return n_;
 }
 
+/**
+ * Computes the statistics of a batch of samples in parallel. The samples are
+ * split into one contiguous range per thread, each thread accumulates its own
+ * Stats using updateBatch() and the partial results are merged afterwards.
+ *
+ * @param data pointer to the first sample
+ * @param count number of samples
+ * @param weights optional pointer to count weights, 1.0 is used if not given
+ * @param threads number of threads, 0 uses the hardware concurrency
+ */
+template <class T, class Moments = FullCovariance>
+Stats<T, Moments> parallelStats( const T* data, size_t count,
+	const double* weights = nullptr, size_t threads = 0 )
+{
+    typedef Stats<T, Moments> StatsType;
+    size_t chunks = chunkCount( count, threads );
+    std::vector< StatsType, Eigen::aligned_allocator<StatsType> > partial( chunks );
+    parallelChunks( count, chunks, [&]( size_t i, size_t begin, size_t end )
+    {
+	partial[i].updateBatch( data + begin, end - begin, weights ? weights + begin : nullptr );
+    });
+
+    for( size_t i = 1; i < chunks; i++ )
+	partial[0].merge( partial[i] );
+    return partial[0];
+}
+
+/**
+ * Computes the statistics over the columns of an Eigen matrix in parallel,
+ * where each column is one sample of type T (e.g. Eigen::Vector3d or
+ * base::VectorXd). The column range is split into one contiguous range per
+ * thread and the per thread accumulators are merged afterwards.
+ *
+ * @code
+ * Stats<base::VectorXd> s = parallelStats<base::VectorXd>( data );
+ * @endcode
+ *
+ * @param data matrix with one sample per column
+ * @param threads number of threads, 0 uses the hardware concurrency
+ */
+template <class T, class Moments = FullCovariance, class Derived>
+Stats<T, Moments> parallelStats( const Eigen::MatrixBase<Derived>& data, size_t threads = 0 )
+{
+    typedef Stats<T, Moments> StatsType;
+    size_t count = data.cols();
+    size_t chunks = chunkCount( count, threads );
+    std::vector< StatsType, Eigen::aligned_allocator<StatsType> > partial( chunks );
+    parallelChunks( count, chunks, [&]( size_t i, size_t begin, size_t end )
+    {
+	T sample;
+	for( size_t c = begin; c < end; c++ )
+	{
+	    sample = data.col( c );
+	    partial[i].update( sample );
+	}
+    });
+
+    for( size_t i = 1; i < chunks; i++ )
+	partial[0].merge( partial[i] );
+    return partial[0];
+}
+
 /** Compute statistics for multiple time series given as a matrix (eigen matrix).
  *
  * One column is an observation and each row is a data item.
@@ -244,8 +676,14 @@ class SeriesStats {
 
 protected:
 
+    /** Number of columns processed at once, so that a block of
+     * rows x blockCols doubles fits into the cache. */
+    static size_t blockCols(size_t rows) {
+        return std::max<size_t>(16, (size_t(1) << 15) / std::max<size_t>(rows, 1));
+    }
+
     template<typename Derived>
-    Eigen::VectorXd weightOnes(const Eigen::MatrixBase<Derived>& data) {
+    typename Eigen::VectorXd::ConstantReturnType weightOnes(const Eigen::MatrixBase<Derived>& data) {
         return Eigen::VectorXd::Ones(data.cols());
     }
 
@@ -266,18 +704,62 @@ protected:
         compute(data, weights, 0.0);
     }
 
+    /** Computes the statistics in two passes over column blocks of the data.
+     *
+     * The first pass accumulates min, max and the weighted sum, the second
+     * one the outer products of the centered, weighted columns. Only block
+     * sized buffers are allocated. The column range is split into one
+     * contiguous range per thread, partial results are reduced afterwards.
+     */
     template <typename Derived1, typename Derived2>
     void compute (const Eigen::MatrixBase<Derived1>& data,
-                  const Eigen::MatrixBase<Derived2>& weights, double ddof) {
+                  const Eigen::MatrixBase<Derived2>& weights, double ddof,
+                  size_t threads = 1) {
 
-        min_ = data.array().rowwise().minCoeff();
-        max_ = data.array().rowwise().maxCoeff();
+        const size_t rows = data.rows();
+        const size_t block = blockCols(rows);
         n_ = data.cols();
-        double w_sum = weights.sum();
-        Eigen::MatrixXd weighted_data = data * (weights / w_sum * n_).asDiagonal();
-        mean_ = weighted_data.rowwise().mean();
-        Eigen::MatrixXd centered_data = weighted_data.colwise() - mean_;
-        var_ = centered_data * centered_data.adjoint() / ( n_ - ddof );
+        // weights are normalized so that they sum up to the number of samples
+        const double scale = n_ / weights.sum();
+
+        const size_t chunks = chunkCount(n_, threads);
+        std::vector<Eigen::VectorXd> p_min(chunks, Eigen::VectorXd::Constant(rows, std::numeric_limits<double>::infinity()));
+        std::vector<Eigen::VectorXd> p_max(chunks, Eigen::VectorXd::Constant(rows, -std::numeric_limits<double>::infinity()));
+        std::vector<Eigen::VectorXd> p_sum(chunks, Eigen::VectorXd::Zero(rows));
+        parallelChunks(n_, chunks, [&](size_t i, size_t begin, size_t end) {
+            Eigen::VectorXd w(block);
+            for (size_t b = begin; b < end; b += block) {
+                const size_t len = std::min(block, end - b);
+                w.head(len) = weights.segment(b, len) * scale;
+                p_min[i] = p_min[i].cwiseMin(data.middleCols(b, len).rowwise().minCoeff());
+                p_max[i] = p_max[i].cwiseMax(data.middleCols(b, len).rowwise().maxCoeff());
+                p_sum[i].noalias() += data.middleCols(b, len) * w.head(len);
+            }
+        });
+        for (size_t i = 1; i < chunks; i++) {
+            p_min[0] = p_min[0].cwiseMin(p_min[i]);
+            p_max[0] = p_max[0].cwiseMax(p_max[i]);
+            p_sum[0] += p_sum[i];
+        }
+        min_ = p_min[0];
+        max_ = p_max[0];
+        mean_ = p_sum[0] / n_;
+
+        std::vector<Eigen::MatrixXd> p_var(chunks, Eigen::MatrixXd::Zero(rows, rows));
+        parallelChunks(n_, chunks, [&](size_t i, size_t begin, size_t end) {
+            Eigen::VectorXd w(block);
+            Eigen::MatrixXd centered(rows, block);
+            for (size_t b = begin; b < end; b += block) {
+                const size_t len = std::min(block, end - b);
+                w.head(len) = weights.segment(b, len) * scale;
+                centered.leftCols(len) = (data.middleCols(b, len) * w.head(len).asDiagonal()).colwise() - mean_;
+                p_var[i].selfadjointView<Eigen::Lower>().rankUpdate(centered.leftCols(len));
+            }
+        });
+        for (size_t i = 1; i < chunks; i++)
+            p_var[0] += p_var[i];
+        var_ = p_var[0].selfadjointView<Eigen::Lower>();
+        var_ /= ( n_ - ddof );
         stdev_ = var_.diagonal().array().sqrt();
     }
 
@@ -311,6 +793,16 @@ public:
         compute(data, weights, ddof);
     }
 
+    /** Same as above, but splits the columns over the given number of threads.
+     *
+     * \param threads Number of threads, 0 uses the hardware concurrency.
+     */
+    template <typename Derived1, typename Derived2>
+    SeriesStats(const Eigen::MatrixBase<Derived1>& data,
+                const Eigen::MatrixBase<Derived2>& weights, double ddof, size_t threads) {
+        compute(data, weights, ddof, threads);
+    }
+
     const Eigen::VectorXd& min() const { return min_; }
     const Eigen::VectorXd& max() const { return max_; }
     const Eigen::VectorXd& mean() const { return mean_; }
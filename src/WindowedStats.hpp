@@ -0,0 +1,418 @@
+#ifndef __NUMERIC_WINDOWED_STATS_HPP__
+#define __NUMERIC_WINDOWED_STATS_HPP__
+
+#include <deque>
+#include <vector>
+#include <stdint.h>
+#include <Eigen/StdVector>
+#include "Stats.hpp"
+
+namespace numeric
+{
+
+/**
+ * Access to the individual elements of a sample, so that the per element
+ * min/max tracking works the same way for scalars and Eigen vectors.
+ */
+template <class T>
+struct ElementAccess
+{
+    static size_t size( T const& a ) { return 1; }
+    static T get( T const& a, size_t i ) { return a; }
+    static void set( T& a, size_t i, T value ) { a = value; }
+};
+
+template <class _Scalar, int _Rows, int _Options>
+struct ElementAccess< Eigen::Matrix<_Scalar, _Rows, 1, _Options> >
+{
+    typedef Eigen::Matrix<_Scalar, _Rows, 1, _Options> T;
+    static size_t size( T const& a ) { return a.size(); }
+    static _Scalar get( T const& a, size_t i ) { return a[i]; }
+    static void set( T& a, size_t i, _Scalar value ) { a[i] = value; }
+};
+
+/** Clamps negative variances caused by rounding to zero */
+template <class S>
+inline void clampVariance( S& m2 )
+{
+    if( m2 < 0 )
+	m2 = 0;
+}
+
+template <class _Scalar, int _Rows, int _Cols, int _Options, int _MaxRows, int _MaxCols>
+inline void clampVariance( Eigen::Matrix<_Scalar, _Rows, _Cols, _Options, _MaxRows, _MaxCols>& m2 )
+{
+    m2.diagonal() = m2.diagonal().cwiseMax( _Scalar( 0 ) );
+}
+
+/**
+ * Statistics over a sliding window of samples. The window is limited by the
+ * number of samples, by the time span of the samples, or both.
+ *
+ * The samples of the window are kept in a ring buffer. Mean and variance are
+ * updated incrementally, evicted samples are removed with the reverse of the
+ * weighted West update. Min and max are tracked per element with monotonic
+ * deques, so that every update is O(1) amortized and min and max never
+ * re-scan the window.
+ *
+ * Note that the removal accumulates floating point errors over time. To
+ * bound them, mean and variance are recomputed from the ring buffer each
+ * time as many samples have been evicted as remain in the window, which
+ * keeps the update O(1) amortized. They are also recomputed when the
+ * remaining weight drops to zero.
+ *
+ * @code
+ * WindowedStats<double> s( 100 ); // last 100 samples
+ * WindowedStats<double> t( 0, 2.0 ); // samples of the last 2 seconds
+ * t.updateAt( time, value );
+ * @endcode
+ */
+template <class T>
+class WindowedStats
+{
+    typedef typename Square<T>::Type SquareType;
+
+    struct Sample
+    {
+	T data;
+	double weight;
+	double time;
+	EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+    };
+
+    typedef std::vector< Sample, Eigen::aligned_allocator<Sample> > Buffer;
+
+    size_t max_samples_;
+    double max_duration_;
+
+    /** ring buffer of the samples in the window */
+    Buffer buffer_;
+    size_t head_;
+    size_t size_;
+    /** sequence number of the oldest sample in the window */
+    uint64_t first_seq_;
+
+    /** sequence numbers of the min/max candidates, one deque per element */
+    std::vector< std::deque<uint64_t> > min_idx_;
+    std::vector< std::deque<uint64_t> > max_idx_;
+
+    SquareType M2_;
+    T mean_;
+    double sum_weight_;
+    /** evictions since mean and variance were last recomputed */
+    size_t evictions_;
+    /** time of the last updateAt() or expire() */
+    double time_;
+
+    double ddof_;
+
+    void init( T const& data );
+    void add( T const& data, double weight );
+    void recompute();
+    const Sample& at( uint64_t seq ) const;
+    void push( T const& data, double weight, double time );
+    void pop();
+    T zero() const;
+
+public:
+    /**
+     * @param max_samples maximum number of samples in the window, 0 for no limit
+     * @param max_duration maximum time span of the samples in the window,
+     *        0 for no limit. Samples added with update() carry the time of
+     *        the last updateAt() or expire() call, or 0 if there was none
+     *        since the last clear(), and are evicted by time like the
+     *        samples around them.
+     */
+    explicit WindowedStats( size_t max_samples, double max_duration = 0.0 );
+
+    /** Adds a sample and evicts the oldest one if the window is full */
+    void update( T const& data, double weight = 1.0 );
+
+    /**
+     * Adds a sample taken at the given time in seconds and evicts all samples
+     * which are older than time - max_duration. Times need to be monotonic.
+     */
+    void updateAt( double time, T const& data, double weight = 1.0 );
+
+    /** Evicts all samples which are older than time - max_duration */
+    void expire( double time );
+
+    void clear();
+
+    /** Per element minimum of the window, zero if the window is empty */
+    T min() const;
+    /** Per element maximum of the window, zero if the window is empty */
+    T max() const;
+    /** Weighted mean of the window, zero if the window is empty */
+    T mean() const;
+    SquareType var() const;
+    T stdev() const;
+    double sumWeights() const;
+    size_t n() const;
+
+    /** @see Stats::setDDof() */
+    void setDDof(double new_ddof) { ddof_ = new_ddof; }
+};
+
+template <class T>
+WindowedStats<T>::WindowedStats( size_t max_samples, double max_duration )
+    : max_samples_( max_samples ), max_duration_( max_duration ), ddof_( 0.0 )
+{
+    buffer_.resize( max_samples ? max_samples : 16 );
+    clear();
+}
+
+template <class T>
+void WindowedStats<T>::clear()
+{
+    head_ = 0;
+    size_ = 0;
+    first_seq_ = 0;
+    time_ = 0.0;
+    min_idx_.clear();
+    max_idx_.clear();
+}
+
+template <class T>
+void WindowedStats<T>::init( T const& data )
+{
+    sum_weight_ = 0.0;
+    evictions_ = 0;
+    M2_ = Zero<SquareType>::value();
+    mean_ = Zero<T>::value();
+}
+
+template <>
+inline void WindowedStats<base::VectorXd>::init( base::VectorXd const& data )
+{
+    int rows = data.rows();
+
+    sum_weight_ = 0.0;
+    evictions_ = 0;
+    M2_ = base::MatrixXd::Zero(rows,rows);
+    mean_ = base::VectorXd::Zero(rows);
+}
+
+template <class T>
+const typename WindowedStats<T>::Sample& WindowedStats<T>::at( uint64_t seq ) const
+{
+    return buffer_[ (head_ + (seq - first_seq_)) % buffer_.size() ];
+}
+
+template <class T>
+void WindowedStats<T>::push( T const& data, double weight, double time )
+{
+    if( max_samples_ && size_ == max_samples_ )
+	pop();
+
+    if( !size_ )
+    {
+	init( data );
+	min_idx_.assign( ElementAccess<T>::size( data ), std::deque<uint64_t>() );
+	max_idx_.assign( ElementAccess<T>::size( data ), std::deque<uint64_t>() );
+    }
+
+    if( size_ == buffer_.size() )
+    {
+	// only happens for time limited windows, grow the ring
+	Buffer grown( buffer_.size() * 2 );
+	for( size_t i = 0; i < size_; i++ )
+	    grown[i] = buffer_[ (head_ + i) % buffer_.size() ];
+	buffer_.swap( grown );
+	head_ = 0;
+    }
+
+    const uint64_t seq = first_seq_ + size_;
+    Sample& s( buffer_[ (head_ + size_) % buffer_.size() ] );
+    s.data = data;
+    s.weight = weight;
+    s.time = time;
+    size_++;
+
+    add( data, weight );
+
+    // candidates which are dominated by the new sample can never become
+    // min or max again before they are evicted
+    for( size_t i = 0; i < min_idx_.size(); i++ )
+    {
+	const auto value = ElementAccess<T>::get( data, i );
+	std::deque<uint64_t>& mi( min_idx_[i] );
+	while( !mi.empty() && ElementAccess<T>::get( at( mi.back() ).data, i ) >= value )
+	    mi.pop_back();
+	mi.push_back( seq );
+
+	std::deque<uint64_t>& ma( max_idx_[i] );
+	while( !ma.empty() && ElementAccess<T>::get( at( ma.back() ).data, i ) <= value )
+	    ma.pop_back();
+	ma.push_back( seq );
+    }
+}
+
+template <class T>
+void WindowedStats<T>::add( T const& data, double weight )
+{
+    // weighted West update, same as in Stats::update()
+    double temp = weight + sum_weight_;
+    if( temp <= 0.0 )
+	return;
+    T delta = data - mean_;
+    T R = delta * weight / temp;
+    mean_ = mean_ + R;
+    M2_ = M2_ + sum_weight_ * Square<T>::value( delta, R );
+    sum_weight_ = temp;
+}
+
+template <class T>
+void WindowedStats<T>::recompute()
+{
+    init( at( first_seq_ ).data );
+    for( uint64_t seq = first_seq_; seq < first_seq_ + size_; seq++ )
+	add( at( seq ).data, at( seq ).weight );
+}
+
+template <class T>
+void WindowedStats<T>::pop()
+{
+    const Sample& s( at( first_seq_ ) );
+
+    if( size_ == 1 )
+    {
+	clear();
+	return;
+    }
+
+    // reverse of the weighted West update, the state is recomputed below
+    // if no weight is left
+    double temp = sum_weight_ - s.weight;
+    if( temp > 0.0 )
+    {
+	T delta = s.data - mean_;
+	T R = delta * s.weight / temp;
+	mean_ = mean_ - R;
+	M2_ = M2_ - sum_weight_ * Square<T>::value( delta, R );
+	clampVariance( M2_ );
+    }
+    sum_weight_ = temp;
+
+    for( size_t i = 0; i < min_idx_.size(); i++ )
+    {
+	if( min_idx_[i].front() == first_seq_ )
+	    min_idx_[i].pop_front();
+	if( max_idx_[i].front() == first_seq_ )
+	    max_idx_[i].pop_front();
+    }
+
+    head_ = (head_ + 1) % buffer_.size();
+    first_seq_++;
+    size_--;
+
+    if( temp <= 0.0 || ++evictions_ >= size_ )
+	recompute();
+}
+
+template <class T>
+void WindowedStats<T>::update( T const& data, double weight )
+{
+    push( data, weight, time_ );
+}
+
+template <class T>
+void WindowedStats<T>::updateAt( double time, T const& data, double weight )
+{
+    time_ = time;
+    push( data, weight, time );
+    expire( time );
+}
+
+template <class T>
+void WindowedStats<T>::expire( double time )
+{
+    time_ = time;
+    if( max_duration_ <= 0.0 )
+	return;
+
+    while( size_ && at( first_seq_ ).time < time - max_duration_ )
+	pop();
+}
+
+template <class T>
+double WindowedStats<T>::sumWeights() const
+{
+    return size_ ? sum_weight_ : 0.0;
+}
+
+template <class T>
+size_t WindowedStats<T>::n() const
+{
+    return size_;
+}
+
+template <class T>
+T WindowedStats<T>::zero() const
+{
+    return Zero<T>::value();
+}
+
+template <>
+inline base::VectorXd WindowedStats<base::VectorXd>::zero() const
+{
+    // the dimension of the last samples, empty if there never were any
+    return base::VectorXd::Zero(mean_.rows());
+}
+
+template <class T>
+T WindowedStats<T>::mean() const
+{
+    return size_ ? mean_ : zero();
+}
+
+template <class T>
+inline typename WindowedStats<T>::SquareType WindowedStats<T>::var() const
+{
+    return (size_ && sum_weight_ > 0.0) ? SquareType(M2_ / (sum_weight_ - ddof_)) : Zero<SquareType>::value();
+}
+
+template <>
+inline WindowedStats<base::VectorXd>::SquareType WindowedStats<base::VectorXd>::var() const
+{
+    return (size_ && sum_weight_ > 0.0) ? SquareType(M2_ / (sum_weight_ - ddof_)) :
+        base::MatrixXd::Zero(M2_.rows(),M2_.cols());
+}
+
+template <class T>
+T WindowedStats<T>::stdev() const
+{
+    return sqrt( var() );
+}
+
+template <>
+inline base::VectorXd WindowedStats<base::VectorXd>::stdev() const
+{
+    return var().diagonal().array().sqrt();
+}
+
+template <class T>
+T WindowedStats<T>::min() const
+{
+    if( !size_ )
+	return zero();
+    T result = at( first_seq_ ).data;
+    for( size_t i = 0; i < min_idx_.size(); i++ )
+	ElementAccess<T>::set( result, i, ElementAccess<T>::get( at( min_idx_[i].front() ).data, i ) );
+    return result;
+}
+
+template <class T>
+T WindowedStats<T>::max() const
+{
+    if( !size_ )
+	return zero();
+    T result = at( first_seq_ ).data;
+    for( size_t i = 0; i < max_idx_.size(); i++ )
+	ElementAccess<T>::set( result, i, ElementAccess<T>::get( at( max_idx_[i].front() ).data, i ) );
+    return result;
+}
+
+}
+
+#endif
@@ -0,0 +1,241 @@
+// Micro benchmarks for the numeric library. Not part of the unit tests, run
+// the benchmark executable manually on an otherwise idle machine.
+#include <numeric/DiscreteFilter.hpp>
+#include <numeric/Histogram.hpp>
+#include <numeric/PolynomialFitting.hpp>
+#include <numeric/QuantileSketch.hpp>
+#include <numeric/SavitzkyGolayFilter.hpp>
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <stdlib.h>
+#include <vector>
+
+namespace
+{
+
+/** runs f repeat times and returns the mean wall clock time in ms */
+template <class F>
+double timeIt( F f, int repeat = 5 )
+{
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for( int i = 0; i < repeat; i++ )
+	f();
+    std::chrono::duration<double, std::milli> d = std::chrono::steady_clock::now() - start;
+    return d.count() / repeat;
+}
+
+std::vector<double> randomData( size_t count )
+{
+    std::vector<double> data( count );
+    srand( 42 );
+    for( size_t i = 0; i < count; i++ )
+	data[i] = rand() / (double)RAND_MAX;
+    return data;
+}
+
+void benchQuantileSketch()
+{
+    const size_t count = 10000000;
+    std::vector<double> data = randomData( count );
+    volatile double sink = 0;
+
+    double t_sort = timeIt( [&]()
+    {
+	std::vector<double> copy( data );
+	std::sort( copy.begin(), copy.end() );
+	sink = copy[ count / 2 ] + copy[ count * 99 / 100 ];
+    });
+
+    numeric::QuantileSketch sketch;
+    double t_sketch = timeIt( [&]()
+    {
+	sketch.clear();
+	for( size_t i = 0; i < count; i++ )
+	    sketch.update( data[i] );
+	sink = sketch.quantile( 0.5 ) + sketch.quantile( 0.99 );
+    });
+
+    std::cout << "quantiles of " << count << " values" << std::endl
+	<< "  full sort:       " << t_sort << " ms, "
+	<< count * sizeof(double) / 1024 << " kB" << std::endl
+	<< "  QuantileSketch:  " << t_sketch << " ms, "
+	<< sketch.memoryUsage() / 1024 << " kB" << std::endl;
+}
+
+void benchHistogram()
+{
+    const size_t count = 50000000;
+    std::vector<double> data = randomData( count );
+    numeric::Histogram h( 100, 0.0, 1.0 );
+
+    double t_single = timeIt( [&]()
+    {
+	for( size_t i = 0; i < count; i++ )
+	    h.update( data[i] );
+    });
+    double t_bulk = timeIt( [&]()
+    {
+	h.update( &data[0], &data[0] + count );
+    });
+    double t_parallel = timeIt( [&]()
+    {
+	h.update( &data[0], &data[0] + count, 0 );
+    });
+
+    std::cout << "histogram of " << count << " values" << std::endl
+	<< "  update( value ):          " << t_single << " ms" << std::endl
+	<< "  update( begin, end ):     " << t_bulk << " ms" << std::endl
+	<< "  update( begin, end, 0 ):  " << t_parallel << " ms, "
+	<< numeric::defaultThreadCount() << " threads" << std::endl;
+}
+
+void benchDiscreteFilter()
+{
+    const int channels = 200;
+    const int samples = 100000;
+    numeric::DiscreteFilter filter( 0.001, channels );
+    filter.setPoles( -50.0, -80.0 );
+    base::MatrixXd block = base::MatrixXd::Random( channels, samples );
+    base::VectorXd input( channels );
+    base::VectorXd output( channels );
+
+    double t_filter = timeIt( [&]()
+    {
+	for( int i = 0; i < samples; i++ )
+	{
+	    input = block.col( i );
+	    filter.calcOutput( output, input );
+	    block.col( i ) = output;
+	}
+    });
+
+    double t_block = timeIt( [&]()
+    {
+	filter.process( block );
+    });
+
+    std::cout << "discrete filter, " << channels << " channels x " << samples << " samples" << std::endl
+	<< "  calcOutput:  " << t_filter << " ms, "
+	<< t_filter * 1e6 / samples << " ns per sample" << std::endl
+	<< "  process:     " << t_block << " ms, "
+	<< t_block * 1e6 / samples << " ns per sample" << std::endl;
+}
+
+/** the former doubly recursive Gram polynomial evaluation, for comparison */
+double recursiveGramPolynomial( int i, int m, int k, int s )
+{
+    if( k > 0 )
+    {
+	double gp1 = i * recursiveGramPolynomial( i, m, k-1, s ) + s * recursiveGramPolynomial( i, m, k-1, s-1 );
+	double gp2 = recursiveGramPolynomial( i, m, k-2, s );
+	double k1 = (double)(4*k-2) / (k*(2*m-k+1));
+	double k2 = (double)((k-1)*(2*m+k)) / (k*(2*m-k+1));
+	return k1 * gp1 - k2 * gp2;
+    }
+    return k == 0 && s == 0 ? 1.0 : 0.0;
+}
+
+double generalizedFactorial( int a, int b )
+{
+    double f = 1;
+    if( b > 0 && a > b )
+	for( int i = a-b+1; i <= a; i++ )
+	    f *= i;
+    return f;
+}
+
+void recursiveSavitzkyGolay( std::vector<double>& result, int t, int m, int n, int s )
+{
+    result.clear();
+    for( int i = -m; i <= m; i++ )
+    {
+	double sum = 0;
+	for( int k = 0; k <= n; k++ )
+	    sum += (double)(2*k+1) * generalizedFactorial( 2*m, k ) / generalizedFactorial( 2*m+k+1, k+1 )
+		* recursiveGramPolynomial( i, m, k, 0 ) * recursiveGramPolynomial( t, m, k, s );
+	result.push_back( sum );
+    }
+}
+
+void benchSavitzkyGolay()
+{
+    const int half_width = 12;
+    std::vector<double> coeff;
+    volatile double sink = 0;
+
+    std::cout << "Savitzky-Golay coefficients, all ls_points, derivatives 0-2, "
+	<< 2 * half_width + 1 << " points" << std::endl;
+    for( int order = 2; order <= 10; order += 2 )
+    {
+	double t_recursive = timeIt( [&]()
+	{
+	    for( int s = 0; s <= 2; s++ )
+		for( int t = -half_width; t <= half_width; t++ )
+		{
+		    recursiveSavitzkyGolay( coeff, t, half_width, order, s );
+		    sink = coeff[0];
+		}
+	}, 1 );
+	double t_table = timeIt( [&]()
+	{
+	    for( int s = 0; s <= 2; s++ )
+		for( int t = -half_width; t <= half_width; t++ )
+		{
+		    numeric::SavitzkyGolayFilter( coeff, t, half_width, order, s );
+		    sink = coeff[0];
+		}
+	}, 1 );
+	std::cout << "  order " << order << ":  recursive " << t_recursive
+	    << " ms, table " << t_table << " ms" << std::endl;
+    }
+}
+
+void benchSlidingPolynomialFit()
+{
+    const int count = 1000000;
+    const int window = 32;
+    std::vector<double> data = randomData( count );
+    std::vector<double> x( window ), result;
+    for( int i = 0; i < window; i++ )
+	x[i] = i - (window - 1);
+    double chisq;
+    volatile double sink = 0;
+
+    numeric::QRPolyFitter fitter( 3, window );
+    double t_refit = timeIt( [&]()
+    {
+	for( int i = window - 1; i < count; i++ )
+	{
+	    fitter.fit( window, x.begin(), &data[i - window + 1], result, chisq );
+	    sink = result[0];
+	}
+    }, 1 );
+
+    double t_online = timeIt( [&]()
+    {
+	numeric::SlidingPolynomialFit<double, 2> fit( window );
+	for( int i = 0; i < count; i++ )
+	{
+	    fit.update( data[i] );
+	    if( i >= window - 1 )
+		sink = fit.getCoeffs()[0];
+	}
+    }, 1 );
+
+    std::cout << "sliding quadratic fit, " << count << " samples, window " << window << std::endl
+	<< "  QRPolyFitter refit:    " << t_refit << " ms" << std::endl
+	<< "  SlidingPolynomialFit:  " << t_online << " ms" << std::endl;
+}
+
+}
+
+int main( int argc, char** argv )
+{
+    benchQuantileSketch();
+    benchHistogram();
+    benchDiscreteFilter();
+    benchSavitzkyGolay();
+    benchSlidingPolynomialFit();
+    return 0;
+}
@@ -0,0 +1,83 @@
+// Micro benchmark for the polynomial fit. Not part of the unit tests, run
+// the benchmark executable manually on an otherwise idle machine.
+#include <numeric/FitPolynom.hpp>
+#include <numeric/PolynomialFitting.hpp>
+#include <chrono>
+#include <iostream>
+#include <stdlib.h>
+#include <vector>
+
+namespace
+{
+
+/** runs f repeat times and returns the mean wall clock time in ms */
+template <class F>
+double timeIt( F f, int repeat = 5 )
+{
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for( int i = 0; i < repeat; i++ )
+	f();
+    std::chrono::duration<double, std::milli> d = std::chrono::steady_clock::now() - start;
+    return d.count() / repeat;
+}
+
+void benchSlidingFit()
+{
+    const size_t count = 100000;
+    const size_t window = 16;
+    const int degree = 3;
+    std::vector<double> data( count );
+    srand( 42 );
+    for( size_t i = 0; i < count; i++ )
+	data[i] = rand() / (double)RAND_MAX;
+
+    std::vector<double> result;
+    double chisq;
+    volatile double sink = 0;
+
+    double t_fit_polynom = timeIt( [&]()
+    {
+	for( size_t i = 0; i + window <= count; i++ )
+	{
+	    numeric::fitPolynom( degree, data.begin() + i, data.begin() + i + window, result, chisq );
+	    sink = result[0];
+	}
+    });
+
+    numeric::PolyFitter fitter( degree, window );
+    double t_fitter = timeIt( [&]()
+    {
+	for( size_t i = 0; i + window <= count; i++ )
+	{
+	    fitter.fit( data.begin() + i, data.begin() + i + window, result, chisq );
+	    sink = result[0];
+	}
+    });
+
+    numeric::QRPolyFitter qr_fitter( degree, window );
+    double t_qr = timeIt( [&]()
+    {
+	for( size_t i = 0; i + window <= count; i++ )
+	{
+	    qr_fitter.fit( data.begin() + i, data.begin() + i + window, result, chisq );
+	    sink = result[0];
+	}
+    });
+
+    const size_t fits = count - window + 1;
+    std::cout << "polynomial fit, degree " << degree << ", " << fits << " windows of " << window << " points" << std::endl
+	<< "  fitPolynom:    " << t_fit_polynom << " ms, "
+	<< t_fit_polynom * 1e6 / fits << " ns per fit" << std::endl
+	<< "  PolyFitter:    " << t_fitter << " ms, "
+	<< t_fitter * 1e6 / fits << " ns per fit" << std::endl
+	<< "  QRPolyFitter:  " << t_qr << " ms, "
+	<< t_qr * 1e6 / fits << " ns per fit" << std::endl;
+}
+
+}
+
+int main( int argc, char** argv )
+{
+    benchSlidingFit();
+    return 0;
+}
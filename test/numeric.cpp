@@ -1,9 +1,19 @@
 #define NUMERIC_DEPRECATE 1
 #include <boost/test/unit_test.hpp>
 #include <numeric/Stats.hpp>
+#include <numeric/WindowedStats.hpp>
+#include <numeric/ExponentialStats.hpp>
 #include <numeric/Histogram.hpp>
+#include <numeric/ConcurrentHistogram.hpp>
+#include <numeric/LogHistogram.hpp>
+#include <numeric/HistogramND.hpp>
+#include <numeric/AutoHistogram.hpp>
+#include <numeric/QuantileSketch.hpp>
 #include <numeric/MatchTemplate.hpp>
 #include <numeric/PlaneFitting.hpp>
+#include <numeric/PolynomialFitting.hpp>
+#include <thread>
+#include <stdexcept>
 
 BOOST_AUTO_TEST_SUITE(numeric)
 
@@ -98,6 +108,523 @@ BOOST_AUTO_TEST_CASE( stats_test )
     BOOST_CHECK( mwsta.var().isApprox(sw_var) );
 }
 
+BOOST_AUTO_TEST_CASE( stats_batch_test )
+{
+    // the batch update has to give the same result as the single updates
+    std::vector<double> data, weights;
+    for( int i = 0; i < 10000; i++ )
+    {
+	data.push_back( sin( i * 0.01 ) * 10.0 + i * 1e-3 );
+	weights.push_back( 0.5 + (i % 7) * 0.25 );
+    }
+
+    numeric::Stats<double> single, batch;
+    for( size_t i = 0; i < data.size(); i++ )
+	single.update( data[i] );
+    batch.updateBatch( &data[0], 10 );
+    batch.updateBatch( &data[10], data.size() - 10 );
+    BOOST_CHECK_EQUAL( batch.n(), data.size() );
+
+    numeric::Stats<double> wsingle, wbatch;
+    for( size_t i = 0; i < data.size(); i++ )
+	wsingle.update( data[i], weights[i] );
+    wbatch.updateBatch( &data[0], data.size(), &weights[0] );
+    BOOST_CHECK_EQUAL( wbatch.n(), wsingle.n() );
+    BOOST_CHECK_CLOSE( wbatch.sumWeights(), wsingle.sumWeights(), 1e-9 );
+    BOOST_CHECK_CLOSE( wbatch.mean(), wsingle.mean(), 1e-9 );
+    BOOST_CHECK_CLOSE( wbatch.var(), wsingle.var(), 1e-9 );
+    BOOST_CHECK_EQUAL( wbatch.min(), wsingle.min() );
+    BOOST_CHECK_EQUAL( wbatch.max(), wsingle.max() );
+
+    BOOST_CHECK_CLOSE( batch.mean(), single.mean(), 1e-9 );
+    BOOST_CHECK_CLOSE( batch.var(), single.var(), 1e-9 );
+    BOOST_CHECK_EQUAL( batch.min(), single.min() );
+    BOOST_CHECK_EQUAL( batch.max(), single.max() );
+
+    // fixed size eigen vectors
+    std::vector<Eigen::Vector2d> vdata;
+    for( size_t i = 0; i < data.size(); i++ )
+	vdata.push_back( Eigen::Vector2d( data[i], cos( i * 0.3 ) ) );
+    numeric::Stats<Eigen::Vector2d> vsingle, vbatch;
+    for( size_t i = 0; i < vdata.size(); i++ )
+	vsingle.update( vdata[i], weights[i] );
+    vbatch.updateBatch( &vdata[0], vdata.size(), &weights[0] );
+    BOOST_CHECK( vbatch.mean().isApprox( vsingle.mean(), 1e-9 ) );
+    BOOST_CHECK( vbatch.var().isApprox( vsingle.var(), 1e-9 ) );
+    BOOST_CHECK( vbatch.min() == vsingle.min() );
+    BOOST_CHECK( vbatch.max() == vsingle.max() );
+
+    // base::VectorXd
+    std::vector<base::VectorXd> xdata;
+    for( size_t i = 0; i < vdata.size(); i++ )
+	xdata.push_back( vdata[i] );
+    numeric::Stats<base::VectorXd> xsingle, xbatch;
+    for( size_t i = 0; i < xdata.size(); i++ )
+	xsingle.update( xdata[i] );
+    xbatch.updateBatch( &xdata[0], xdata.size() );
+    BOOST_CHECK( xbatch.mean().isApprox( xsingle.mean(), 1e-9 ) );
+    BOOST_CHECK( xbatch.var().isApprox( xsingle.var(), 1e-9 ) );
+    BOOST_CHECK( xbatch.stdev().isApprox( xsingle.stdev(), 1e-9 ) );
+
+    // integer literals still pick the single sample update
+    numeric::Stats<double> literal;
+    literal.update( 0, 1 );
+    literal.update( 2 );
+    BOOST_CHECK_EQUAL( literal.mean(), 1.0 );
+}
+
+BOOST_AUTO_TEST_CASE( stats_merge_test )
+{
+    base::MatrixXd data(3, 1001);
+    for( int i = 0; i < data.cols(); i++ )
+	data.col(i) << sin( i * 0.1 ), cos( i * 0.01 ) + 2.0, i * 1e-2;
+
+    // merging two halves has to give the same result as a single pass
+    numeric::Stats<double> s, s1, s2;
+    for( int i = 0; i < data.cols(); i++ )
+    {
+	s.update( data(0, i), 1.0 + i % 3 );
+	(i < 300 ? s1 : s2).update( data(0, i), 1.0 + i % 3 );
+    }
+    s1.merge( s2 );
+    BOOST_CHECK_EQUAL( s1.n(), s.n() );
+    BOOST_CHECK_CLOSE( s1.sumWeights(), s.sumWeights(), 1e-9 );
+    BOOST_CHECK_CLOSE( s1.mean(), s.mean(), 1e-9 );
+    BOOST_CHECK_CLOSE( s1.var(), s.var(), 1e-9 );
+    BOOST_CHECK_EQUAL( s1.min(), s.min() );
+    BOOST_CHECK_EQUAL( s1.max(), s.max() );
+
+    // merging an empty accumulator is a no-op, in both directions
+    numeric::Stats<double> empty;
+    s2 = s1;
+    s1.merge( empty );
+    BOOST_CHECK_EQUAL( s1.mean(), s2.mean() );
+    empty.merge( s1 );
+    BOOST_CHECK_EQUAL( empty.mean(), s1.mean() );
+    BOOST_CHECK_EQUAL( empty.n(), s1.n() );
+
+    // parallel drivers
+    std::vector<double> row( data.cols() );
+    for( size_t i = 0; i < row.size(); i++ )
+	row[i] = data(0, i);
+    numeric::Stats<double> ps = numeric::parallelStats( &row[0], row.size(), nullptr, 4 );
+    numeric::Stats<double> ss;
+    ss.updateBatch( &row[0], row.size() );
+    BOOST_CHECK_EQUAL( ps.n(), ss.n() );
+    BOOST_CHECK_CLOSE( ps.mean(), ss.mean(), 1e-9 );
+    BOOST_CHECK_CLOSE( ps.var(), ss.var(), 1e-9 );
+
+    numeric::Stats<base::VectorXd> xs;
+    numeric::Stats<Eigen::Vector3d> vs;
+    for( int i = 0; i < data.cols(); i++ )
+    {
+	xs.update( data.col(i) );
+	vs.update( data.col(i) );
+    }
+    numeric::Stats<base::VectorXd> xp = numeric::parallelStats<base::VectorXd>( data, 3 );
+    numeric::Stats<Eigen::Vector3d> vp = numeric::parallelStats<Eigen::Vector3d>( data, 5 );
+    BOOST_CHECK_EQUAL( xp.n(), xs.n() );
+    BOOST_CHECK( xp.mean().isApprox( xs.mean(), 1e-9 ) );
+    BOOST_CHECK( xp.var().isApprox( xs.var(), 1e-9 ) );
+    BOOST_CHECK( xp.min() == xs.min() );
+    BOOST_CHECK( xp.max() == xs.max() );
+    BOOST_CHECK( vp.mean().isApprox( vs.mean(), 1e-9 ) );
+    BOOST_CHECK( vp.var().isApprox( vs.var(), 1e-9 ) );
+
+    // more threads than samples
+    numeric::Stats<double> few = numeric::parallelStats( &row[0], 2, nullptr, 8 );
+    BOOST_CHECK_EQUAL( few.n(), 2 );
+    BOOST_CHECK_CLOSE( few.mean(), (row[0] + row[1]) / 2.0, 1e-9 );
+}
+
+struct ThrowingChunk
+{
+    std::vector<int>* done;
+    void operator()( size_t i, size_t begin, size_t end ) const
+    {
+	if( i == 0 )
+	    throw std::runtime_error( "first chunk failed" );
+	(*done)[i] = 1;
+    }
+};
+
+BOOST_AUTO_TEST_CASE( parallel_chunks_exception_test )
+{
+    // the exception of the calling thread is passed on after the other
+    // threads are joined, instead of terminating the program
+    std::vector<int> done( 4, 0 );
+    ThrowingChunk f = { &done };
+    BOOST_CHECK_THROW( numeric::parallelChunks( 100, 4, f ), std::runtime_error );
+    BOOST_CHECK_EQUAL( done[1] + done[2] + done[3], 3 );
+}
+
+BOOST_AUTO_TEST_CASE( series_stats_blocked_test )
+{
+    // enough columns to span several blocks
+    base::MatrixXd data(4, 20001);
+    base::VectorXd weights(data.cols());
+    for( int i = 0; i < data.cols(); i++ )
+    {
+	data.col(i) << sin( i * 0.1 ), cos( i * 0.01 ) + 2.0, i * 1e-3, (i % 17) - 8.0;
+	weights(i) = 0.5 + (i % 5) * 0.1;
+    }
+
+    // reference using full size temporaries
+    double ddof = 1.0;
+    double n = data.cols();
+    Eigen::MatrixXd weighted = data * (weights / weights.sum() * n).asDiagonal();
+    Eigen::VectorXd mean = weighted.rowwise().mean();
+    Eigen::MatrixXd centered = weighted.colwise() - mean;
+    Eigen::MatrixXd var = centered * centered.adjoint() / ( n - ddof );
+
+    numeric::SeriesStats single(data, weights, ddof);
+    numeric::SeriesStats parallel(data, weights, ddof, 3);
+    BOOST_CHECK( single.n() == size_t(data.cols()) );
+    BOOST_CHECK( single.mean().isApprox(mean, 1e-9) );
+    BOOST_CHECK( single.var().isApprox(var, 1e-9) );
+    BOOST_CHECK( single.min() == base::VectorXd(data.rowwise().minCoeff()) );
+    BOOST_CHECK( single.max() == base::VectorXd(data.rowwise().maxCoeff()) );
+    BOOST_CHECK( parallel.n() == size_t(data.cols()) );
+    BOOST_CHECK( parallel.mean().isApprox(mean, 1e-9) );
+    BOOST_CHECK( parallel.var().isApprox(var, 1e-9) );
+    BOOST_CHECK( parallel.stdev().isApprox(single.stdev(), 1e-9) );
+    BOOST_CHECK( parallel.min() == single.min() );
+    BOOST_CHECK( parallel.max() == single.max() );
+}
+
+BOOST_AUTO_TEST_CASE( stats_higher_moments_test )
+{
+    std::vector<double> data, weights;
+    for( int i = 0; i < 1000; i++ )
+    {
+	double x = (i % 97) / 97.0;
+	data.push_back( x * x * x * 4.0 + 1.0 );
+	weights.push_back( 1.0 + (i % 3) );
+    }
+
+    // two pass reference
+    double sw = 0, mean = 0;
+    for( size_t i = 0; i < data.size(); i++ )
+    {
+	sw += weights[i];
+	mean += weights[i] * data[i];
+    }
+    mean /= sw;
+    double m2 = 0, m3 = 0, m4 = 0;
+    for( size_t i = 0; i < data.size(); i++ )
+    {
+	double d = data[i] - mean;
+	m2 += weights[i] * d * d / sw;
+	m3 += weights[i] * d * d * d / sw;
+	m4 += weights[i] * d * d * d * d / sw;
+    }
+    double skew = m3 / pow( m2, 1.5 );
+    double kurt = m4 / (m2 * m2) - 3.0;
+
+    numeric::Stats<double, numeric::HigherMoments> s, s1, s2, b;
+    for( size_t i = 0; i < data.size(); i++ )
+    {
+	s.update( data[i], weights[i] );
+	(i < 400 ? s1 : s2).update( data[i], weights[i] );
+    }
+    BOOST_CHECK_CLOSE( s.mean(), mean, 1e-9 );
+    BOOST_CHECK_CLOSE( s.var(), m2, 1e-9 );
+    BOOST_CHECK_CLOSE( s.skewness(), skew, 1e-6 );
+    BOOST_CHECK_CLOSE( s.kurtosis(), kurt, 1e-6 );
+
+    s1.merge( s2 );
+    BOOST_CHECK_CLOSE( s1.skewness(), skew, 1e-6 );
+    BOOST_CHECK_CLOSE( s1.kurtosis(), kurt, 1e-6 );
+
+    b.updateBatch( &data[0], data.size(), &weights[0] );
+    BOOST_CHECK_CLOSE( b.skewness(), skew, 1e-6 );
+    BOOST_CHECK_CLOSE( b.kurtosis(), kurt, 1e-6 );
+
+    // per element for vectors
+    numeric::Stats<Eigen::Vector2d, numeric::HigherMoments> v;
+    numeric::Stats<base::VectorXd, numeric::HigherMoments> x;
+    for( size_t i = 0; i < data.size(); i++ )
+    {
+	v.update( Eigen::Vector2d( data[i], -data[i] ), weights[i] );
+	x.update( Eigen::Vector2d( data[i], -data[i] ), weights[i] );
+    }
+    BOOST_CHECK_CLOSE( v.skewness()(0), skew, 1e-6 );
+    BOOST_CHECK_CLOSE( v.skewness()(1), -skew, 1e-6 );
+    BOOST_CHECK_CLOSE( v.kurtosis()(1), kurt, 1e-6 );
+    BOOST_CHECK( x.skewness().isApprox( v.skewness() ) );
+    BOOST_CHECK( x.kurtosis().isApprox( v.kurtosis() ) );
+    BOOST_CHECK( x.stdev().isApprox( v.stdev() ) );
+}
+
+BOOST_AUTO_TEST_CASE( stats_policy_test )
+{
+    typedef Eigen::Matrix<double, 10, 1> Vector10d;
+    BOOST_CHECK( sizeof( numeric::Stats<Vector10d, numeric::MeanOnly> )
+	    < sizeof( numeric::Stats<Vector10d, numeric::DiagonalVariance> ) );
+    BOOST_CHECK( sizeof( numeric::Stats<Vector10d, numeric::DiagonalVariance> )
+	    < sizeof( numeric::Stats<Vector10d> ) );
+
+    numeric::Stats<Vector10d> full;
+    numeric::Stats<Vector10d, numeric::DiagonalVariance> diag, diag1, diag2, diag_batch;
+    numeric::Stats<Vector10d, numeric::MeanOnly> mean;
+    numeric::Stats<base::VectorXd, numeric::DiagonalVariance> xdiag;
+    std::vector<Vector10d> data;
+    for( int i = 0; i < 100; i++ )
+    {
+	Vector10d v;
+	for( int j = 0; j < v.size(); j++ )
+	    v(j) = sin( i * 0.1 * (j + 1) );
+	data.push_back( v );
+	full.update( v, 1.0 + i % 2 );
+	diag.update( v, 1.0 + i % 2 );
+	(i < 30 ? diag1 : diag2).update( v, 1.0 + i % 2 );
+	mean.update( v );
+	xdiag.update( v, 1.0 + i % 2 );
+    }
+    diag_batch.updateBatch( &data[0], data.size() );
+    diag1.merge( diag2 );
+
+    Vector10d var = full.var().diagonal();
+    BOOST_CHECK( diag.mean().isApprox( full.mean() ) );
+    BOOST_CHECK( diag.var().isApprox( var ) );
+    BOOST_CHECK( diag.stdev().isApprox( full.stdev() ) );
+    BOOST_CHECK( diag1.var().isApprox( var ) );
+    BOOST_CHECK( xdiag.var().isApprox( var ) );
+    BOOST_CHECK( diag.min() == full.min() );
+    BOOST_CHECK( diag.max() == full.max() );
+
+    numeric::Stats<Vector10d, numeric::DiagonalVariance> unweighted;
+    for( size_t i = 0; i < data.size(); i++ )
+	unweighted.update( data[i] );
+    BOOST_CHECK( diag_batch.var().isApprox( unweighted.var() ) );
+
+    BOOST_CHECK_EQUAL( mean.n(), data.size() );
+    Vector10d sum = Vector10d::Zero();
+    for( size_t i = 0; i < data.size(); i++ )
+	sum += data[i];
+    BOOST_CHECK( mean.mean().isApprox( sum / data.size() ) );
+}
+
+BOOST_AUTO_TEST_CASE( windowed_stats_test )
+{
+    std::vector<double> data;
+    for( int i = 0; i < 500; i++ )
+	data.push_back( sin( i * 0.37 ) * 5.0 + (i % 11) );
+
+    // count limited window, compared against a fresh Stats over the window
+    const size_t window = 20;
+    numeric::WindowedStats<double> ws( window );
+    for( size_t i = 0; i < data.size(); i++ )
+    {
+	ws.update( data[i], 1.0 + i % 3 );
+	numeric::Stats<double> ref;
+	for( size_t j = i + 1 - std::min( i + 1, window ); j <= i; j++ )
+	    ref.update( data[j], 1.0 + j % 3 );
+
+	BOOST_CHECK_EQUAL( ws.n(), ref.n() );
+	BOOST_CHECK_CLOSE( ws.mean(), ref.mean(), 1e-6 );
+	BOOST_CHECK_CLOSE( ws.sumWeights(), ref.sumWeights(), 1e-9 );
+	if( ref.n() > 1 )
+	    BOOST_CHECK_CLOSE( ws.var(), ref.var(), 1e-6 );
+	BOOST_CHECK_EQUAL( ws.min(), ref.min() );
+	BOOST_CHECK_EQUAL( ws.max(), ref.max() );
+    }
+
+    // the remaining samples have no weight
+    numeric::WindowedStats<double> zs( 2 );
+    zs.update( 1, 1 );
+    zs.update( 2, 0 );
+    zs.update( 3, 1 );
+    BOOST_CHECK_EQUAL( zs.mean(), 3.0 );
+    for( int i = 0; i < 10; i++ )
+	zs.update( i );
+    BOOST_CHECK_EQUAL( zs.mean(), 8.5 );
+    BOOST_CHECK_CLOSE( zs.var(), 0.25, 1e-9 );
+
+    // noisy segments on a large offset alternating with flat plateaus, the
+    // removal must not drift into negative variances
+    numeric::WindowedStats<double> ps( 100 );
+    srand( 42 );
+    for( int i = 0; i < 2000000; i++ )
+    {
+	double v = 1e6;
+	if( (i / 1000) % 2 )
+	    v += rand() / (double)RAND_MAX * 1000.0;
+	ps.update( v );
+	BOOST_REQUIRE( ps.var() >= 0.0 );
+	if( (i / 1000) % 2 == 0 && i % 1000 >= 100 )
+	    BOOST_REQUIRE_SMALL( ps.var(), 1e-6 );
+    }
+
+    // time limited window with 10 samples per second
+    numeric::WindowedStats<double> ts( 0, 1.0 );
+    for( size_t i = 0; i < 100; i++ )
+	ts.updateAt( i * 0.1, data[i] );
+    BOOST_CHECK_EQUAL( ts.n(), 11 );
+    numeric::Stats<double> tref;
+    for( size_t i = 89; i < 100; i++ )
+	tref.update( data[i] );
+    BOOST_CHECK_CLOSE( ts.mean(), tref.mean(), 1e-6 );
+    BOOST_CHECK_CLOSE( ts.var(), tref.var(), 1e-6 );
+    BOOST_CHECK_EQUAL( ts.min(), tref.min() );
+    BOOST_CHECK_EQUAL( ts.max(), tref.max() );
+    ts.expire( 100.0 );
+    BOOST_CHECK_EQUAL( ts.n(), 0 );
+    BOOST_CHECK_EQUAL( ts.sumWeights(), 0.0 );
+    BOOST_CHECK_EQUAL( ts.mean(), 0.0 );
+    BOOST_CHECK_EQUAL( ts.min(), 0.0 );
+    BOOST_CHECK_EQUAL( ts.max(), 0.0 );
+
+    // samples without a time carry the time of the last updateAt()
+    ts.updateAt( 200.0, 1.0 );
+    ts.update( 2.0 );
+    ts.updateAt( 200.5, 3.0 );
+    BOOST_CHECK_EQUAL( ts.n(), 3 );
+    ts.updateAt( 201.1, 4.0 );
+    BOOST_CHECK_EQUAL( ts.n(), 2 );
+    BOOST_CHECK_EQUAL( ts.min(), 3.0 );
+
+    // vectors, min and max are tracked per element
+    numeric::WindowedStats<Eigen::Vector2d> vs( 5 );
+    numeric::WindowedStats<base::VectorXd> xs( 5 );
+    for( size_t i = 0; i < 50; i++ )
+    {
+	Eigen::Vector2d v( data[i], -data[i] );
+	vs.update( v );
+	xs.update( v );
+    }
+    numeric::Stats<Eigen::Vector2d> vref;
+    for( size_t i = 45; i < 50; i++ )
+	vref.update( Eigen::Vector2d( data[i], -data[i] ) );
+    BOOST_CHECK( vs.mean().isApprox( vref.mean(), 1e-6 ) );
+    BOOST_CHECK( vs.var().isApprox( vref.var(), 1e-6 ) );
+    BOOST_CHECK( vs.min() == vref.min() );
+    BOOST_CHECK( vs.max() == vref.max() );
+    BOOST_CHECK( xs.mean().isApprox( vref.mean(), 1e-6 ) );
+    BOOST_CHECK( xs.var().isApprox( vref.var(), 1e-6 ) );
+    BOOST_CHECK( xs.min() == vref.min() );
+    BOOST_CHECK( xs.max() == vref.max() );
+    xs.clear();
+    BOOST_CHECK( xs.min() == Eigen::Vector2d::Zero() );
+    BOOST_CHECK( xs.max() == Eigen::Vector2d::Zero() );
+    BOOST_CHECK( xs.mean() == Eigen::Vector2d::Zero() );
+}
+
+BOOST_AUTO_TEST_CASE( exponential_stats_test )
+{
+    std::vector<double> data;
+    for( int i = 0; i < 200; i++ )
+	data.push_back( sin( i * 0.37 ) * 5.0 + (i % 11) );
+
+    // the recursion is equal to a weighted mean/variance with exponentially
+    // decaying weights
+    const double alpha = 0.05;
+    numeric::ExponentialStats<double> es( alpha );
+    BOOST_CHECK_EQUAL( es.mean(), 0.0 );
+    BOOST_CHECK_EQUAL( es.var(), 0.0 );
+    numeric::Stats<double> ref;
+    for( size_t i = 0; i < data.size(); i++ )
+    {
+	es.update( data[i] );
+	double w = (i ? alpha : 1.0) * pow( 1.0 - alpha, data.size() - 1 - i );
+	ref.update( data[i], w );
+    }
+    BOOST_CHECK_EQUAL( es.n(), data.size() );
+    BOOST_CHECK_CLOSE( es.mean(), ref.mean(), 1e-6 );
+    BOOST_CHECK_CLOSE( es.var(), ref.var(), 1e-6 );
+    BOOST_CHECK_CLOSE( es.stdev(), sqrt( ref.var() ), 1e-6 );
+
+    // a weight of k is the same as k updates with the same value
+    numeric::ExponentialStats<double> e1( alpha ), e2( alpha );
+    e1.update( 1.0 );
+    e2.update( 1.0 );
+    for( int i = 0; i < 3; i++ )
+	e1.update( 4.0 );
+    e2.update( 4.0, 3.0 );
+    BOOST_CHECK_CLOSE( e1.mean(), e2.mean(), 1e-9 );
+    BOOST_CHECK_CLOSE( e1.var(), e2.var(), 1e-9 );
+
+    numeric::ExponentialStats<double> hl = numeric::ExponentialStats<double>::withHalfLife( 10 );
+    BOOST_CHECK_CLOSE( pow( 1.0 - hl.alpha(), 10 ), 0.5, 1e-9 );
+    BOOST_CHECK_THROW( numeric::ExponentialStats<double>( 0.0 ), std::invalid_argument );
+
+    // vectors
+    numeric::ExponentialStats<Eigen::Vector2d> vs( alpha );
+    numeric::ExponentialStats<base::VectorXd> xs( alpha );
+    for( size_t i = 0; i < data.size(); i++ )
+    {
+	vs.update( Eigen::Vector2d( data[i], 1.0 ) );
+	xs.update( Eigen::Vector2d( data[i], 1.0 ) );
+    }
+    BOOST_CHECK_CLOSE( vs.mean().x(), es.mean(), 1e-6 );
+    BOOST_CHECK_CLOSE( vs.var()(0,0), es.var(), 1e-6 );
+    BOOST_CHECK_SMALL( vs.var()(1,1), 1e-12 );
+    BOOST_CHECK( xs.mean().isApprox( vs.mean() ) );
+    BOOST_CHECK( xs.var().isApprox( vs.var() ) );
+    BOOST_CHECK_CLOSE( xs.stdev()(0), es.stdev(), 1e-6 );
+    xs.clear();
+    BOOST_CHECK( xs.mean() == Eigen::Vector2d::Zero() );
+    BOOST_CHECK( xs.var() == Eigen::Matrix2d::Zero() );
+}
+
+BOOST_AUTO_TEST_CASE( quantile_sketch_test )
+{
+    // permutation of 0..99999
+    std::vector<double> data;
+    for( int i = 0; i < 100000; i++ )
+	data.push_back( (i * 7919) % 100000 );
+
+    numeric::QuantileSketch s, s1, s2;
+    BOOST_CHECK( std::isnan( s.quantile( 0.5 ) ) );
+    for( size_t i = 0; i < data.size(); i++ )
+    {
+	s.update( data[i] );
+	(i % 2 ? s1 : s2).update( data[i] );
+    }
+    BOOST_CHECK_EQUAL( s.n(), data.size() );
+    BOOST_CHECK_EQUAL( s.min(), 0 );
+    BOOST_CHECK_EQUAL( s.max(), 99999 );
+    BOOST_CHECK_EQUAL( s.quantile( 0.0 ), 0 );
+    BOOST_CHECK_EQUAL( s.quantile( 1.0 ), 99999 );
+    BOOST_CHECK_CLOSE( s.median(), 50000, 1.0 );
+    BOOST_CHECK_CLOSE( s.quantile( 0.95 ), 95000, 0.5 );
+    BOOST_CHECK_CLOSE( s.quantile( 0.99 ), 99000, 0.1 );
+    BOOST_CHECK_CLOSE( s.quantile( 0.999 ), 99900, 0.05 );
+    BOOST_CHECK( s.centroidCount() <= 100 );
+
+    s1.merge( s2 );
+    BOOST_CHECK_EQUAL( s1.n(), s.n() );
+    BOOST_CHECK_EQUAL( s1.min(), s.min() );
+    BOOST_CHECK_EQUAL( s1.max(), s.max() );
+    BOOST_CHECK_CLOSE( s1.median(), 50000, 1.0 );
+    BOOST_CHECK_CLOSE( s1.quantile( 0.99 ), 99000, 0.1 );
+
+    // after flush() the queries only read and can run concurrently
+    s.update( 12345.0 );
+    s.flush();
+    const double median = s.median();
+    std::vector<double> medians( 4 );
+    std::vector<std::thread> readers;
+    for( size_t i = 0; i < medians.size(); i++ )
+	readers.push_back( std::thread( [&s, &medians, i]() { medians[i] = s.median(); } ) );
+    for( size_t i = 0; i < readers.size(); i++ )
+    {
+	readers[i].join();
+	BOOST_CHECK_EQUAL( medians[i], median );
+    }
+
+    // weights: values 0 and 1, where 1 has three times the weight
+    numeric::QuantileSketch w;
+    for( int i = 0; i < 1000; i++ )
+    {
+	w.update( 0.0, 1.0 );
+	w.update( 1.0, 3.0 );
+    }
+    BOOST_CHECK_EQUAL( w.sumWeights(), 4000.0 );
+    BOOST_CHECK_SMALL( w.quantile( 0.2 ), 1e-9 );
+    BOOST_CHECK_CLOSE( w.quantile( 0.3 ), 1.0, 1e-9 );
+}
+
 BOOST_AUTO_TEST_CASE( histogram_test )
 {
     numeric::Histogram h( 10, 0.0, 10.0 );
@@ -118,6 +645,266 @@ BOOST_AUTO_TEST_CASE( histogram_test )
     BOOST_CHECK_EQUAL( h[9], 2 );
 }
 
+BOOST_AUTO_TEST_CASE( histogram_bulk_test )
+{
+    std::vector<double> data;
+    for( int i = 0; i < 10000; i++ )
+	data.push_back( sin( i * 0.01 ) * 6.0 + 5.0 );
+    data.push_back( 0.0 );
+    data.push_back( 10.0 );
+
+    numeric::Histogram single( 17, 0.0, 10.0 ), bulk( 17, 0.0, 10.0 ), parallel( 17, 0.0, 10.0 );
+    for( size_t i = 0; i < data.size(); i++ )
+	single.update( data[i] );
+    bulk.update( &data[0], &data[0] + data.size() );
+    parallel.update( &data[0], &data[0] + 5000, 3 );
+    parallel.update( &data[0] + 5000, &data[0] + data.size(), 4 );
+
+    BOOST_CHECK_EQUAL( bulk.total(), single.total() );
+    BOOST_CHECK_EQUAL( parallel.total(), single.total() );
+    for( size_t i = 0; i < single.size(); i++ )
+    {
+	BOOST_CHECK_EQUAL( bulk[i], single[i] );
+	BOOST_CHECK_EQUAL( parallel[i], single[i] );
+    }
+
+    // values on the bucket edges, some of which round down to the lower
+    // bucket, need to be counted the same way by both updates
+    for( int count = 1; count < 200; count++ )
+    {
+	numeric::Histogram edge_single( count, -1.3, 2.9 ), edge_bulk( count, -1.3, 2.9 );
+	std::vector<double> edges;
+	for( int i = 0; i <= count; i++ )
+	    edges.push_back( -1.3 + i * edge_single.getBucketWidth() );
+	for( size_t i = 0; i < edges.size(); i++ )
+	    edge_single.update( edges[i] );
+	edge_bulk.update( &edges[0], &edges[0] + edges.size() );
+	for( int i = 0; i < count; i++ )
+	    BOOST_CHECK_EQUAL( edge_bulk[i], edge_single[i] );
+    }
+}
+
+BOOST_AUTO_TEST_CASE( histogram_query_test )
+{
+    numeric::Histogram h( 8, 0.0, 8.0 ), h2( 8, 0.0, 8.0 );
+    BOOST_CHECK( std::isnan( h.quantile( 0.5 ) ) );
+    BOOST_CHECK_EQUAL( h.cdf( 4.0 ), 0.0 );
+
+    // two values per bin
+    for( int i = 0; i < 8; i++ )
+    {
+	h.update( i + 0.5 );
+	h2.update( i + 0.25 );
+    }
+    BOOST_CHECK_EQUAL( h.getCumulative( 3 ), 4 );
+    BOOST_CHECK_CLOSE( h.quantile( 0.5 ), 4.0, 1e-9 );
+    BOOST_CHECK_CLOSE( h.cdf( 2.0 ), 0.25, 1e-9 );
+
+    // the cumulative counts are invalidated by updates
+    h.update( 7.5 );
+    BOOST_CHECK_EQUAL( h.getCumulative( 7 ), 9 );
+    h[0] += 9;
+    BOOST_CHECK_EQUAL( h.getCumulative( 0 ), 10 );
+    h[0] -= 9;
+
+    h.merge( h2 );
+    BOOST_CHECK_EQUAL( h.total(), 17 );
+    BOOST_CHECK_EQUAL( h[7], 3 );
+    BOOST_CHECK_EQUAL( h.getCumulative( 7 ), 17 );
+    BOOST_CHECK_CLOSE( h.cdf( 8.0 ), 1.0, 1e-9 );
+    BOOST_CHECK_CLOSE( h.cdf( 1.0 ), 2.0 / 17, 1e-9 );
+    BOOST_CHECK_CLOSE( h.cdf( 1.5 ), 3.0 / 17, 1e-9 );
+    BOOST_CHECK_CLOSE( h.quantile( 2.0 / 17 ), 1.0, 1e-9 );
+    BOOST_CHECK_CLOSE( h.quantile( 3.0 / 17 ), 1.5, 1e-9 );
+    BOOST_CHECK_THROW( h.merge( numeric::Histogram( 4, 0.0, 8.0 ) ), std::invalid_argument );
+
+    h.rebin( 4 );
+    BOOST_CHECK_EQUAL( h.size(), 2 );
+    BOOST_CHECK_EQUAL( h[0], 8 );
+    BOOST_CHECK_EQUAL( h[1], 9 );
+    BOOST_CHECK_CLOSE( h.getUpperBound( 0 ), 4.0, 1e-9 );
+    BOOST_CHECK_EQUAL( h.getCumulative( 1 ), 17 );
+    BOOST_CHECK_CLOSE( h.quantile( 8.0 / 17 ), 4.0, 1e-9 );
+    BOOST_CHECK_THROW( h.rebin( 3 ), std::invalid_argument );
+    BOOST_CHECK_THROW( h.rebin( 4 ), std::invalid_argument );
+}
+
+BOOST_AUTO_TEST_CASE( auto_histogram_test )
+{
+    BOOST_CHECK_THROW( numeric::AutoHistogram( 3 ), std::invalid_argument );
+
+    numeric::AutoHistogram h( 4 );
+    BOOST_CHECK_THROW( h.update( NAN ), std::invalid_argument );
+
+    // the first values are buffered and give the initial interval
+    h.update( 0.0 );
+    h.update( 3.0 );
+    h.update( 1.0 );
+    BOOST_CHECK_EQUAL( h.total(), 3 );
+    h.update( 2.0 );
+    BOOST_CHECK_CLOSE( h.histogram().min_val, 0.0, 1e-9 );
+    BOOST_CHECK_CLOSE( h.histogram().max_val, 4.0, 1e-9 );
+    for( int i = 0; i < 4; i++ )
+	BOOST_CHECK_EQUAL( h.histogram()[i], 1 );
+
+    // growing up merges the bins into the lower half
+    h.update( 5.0 );
+    BOOST_CHECK_CLOSE( h.histogram().max_val, 8.0, 1e-9 );
+    BOOST_CHECK_EQUAL( h.histogram()[0], 2 );
+    BOOST_CHECK_EQUAL( h.histogram()[1], 2 );
+    BOOST_CHECK_EQUAL( h.histogram()[2], 1 );
+    BOOST_CHECK_EQUAL( h.histogram()[3], 0 );
+
+    // growing down merges them into the upper half, repeatedly if needed
+    h.update( -20.0 );
+    BOOST_CHECK_CLOSE( h.histogram().min_val, -24.0, 1e-9 );
+    BOOST_CHECK_CLOSE( h.histogram().max_val, 8.0, 1e-9 );
+    BOOST_CHECK_EQUAL( h.histogram()[0], 1 );
+    BOOST_CHECK_EQUAL( h.histogram()[1], 0 );
+    BOOST_CHECK_EQUAL( h.histogram()[2], 0 );
+    BOOST_CHECK_EQUAL( h.histogram()[3], 5 );
+    BOOST_CHECK_EQUAL( h.total(), 6 );
+    BOOST_CHECK_EQUAL( h.histogram().getCumulative( 3 ), 6 );
+
+    h.clear();
+    BOOST_CHECK_EQUAL( h.total(), 0 );
+
+    // a single pass over a stream gives about the same quantiles as a
+    // histogram with the known range
+    numeric::AutoHistogram a( 256 );
+    numeric::Histogram ref( 256, 0.0, 100.0 );
+    srand( 7 );
+    for( int i = 0; i < 100000; i++ )
+    {
+	double v = 100.0 * rand() / RAND_MAX;
+	a.update( v );
+	ref.update( v );
+    }
+    BOOST_CHECK_EQUAL( a.total(), 100000 );
+    BOOST_CHECK_LE( a.histogram().getBucketWidth(), 4 * 100.0 / 255 );
+    BOOST_CHECK_CLOSE( a.histogram().quantile( 0.5 ), ref.quantile( 0.5 ), 1.0 );
+    BOOST_CHECK_CLOSE( a.histogram().quantile( 0.9 ), ref.quantile( 0.9 ), 1.0 );
+}
+
+BOOST_AUTO_TEST_CASE( concurrent_histogram_test )
+{
+    numeric::ConcurrentHistogram h( 10, 0.0, 10.0, 3 );
+    BOOST_CHECK_EQUAL( h.size(), 10 );
+    BOOST_CHECK_EQUAL( h.stripes(), 3 );
+
+    // more threads than stripes, every thread records 1000 values per bin
+    // and the out of range values end up in the edge bins
+    std::vector<std::thread> threads;
+    for( int t = 0; t < 4; t++ )
+	threads.push_back( std::thread( [&h]()
+	{
+	    for( int i = 0; i < 1000; i++ )
+		for( int b = 0; b < 10; b++ )
+		    h.update( b + 0.5 );
+	    h.update( -1.0 );
+	    h.update( 11.0 );
+	}));
+    for( size_t t = 0; t < threads.size(); t++ )
+	threads[t].join();
+
+    numeric::Histogram s = h.snapshot();
+    BOOST_CHECK_EQUAL( s.total(), 4 * 10002 );
+    BOOST_CHECK_EQUAL( s[0], 4004 );
+    BOOST_CHECK_EQUAL( s[5], 4000 );
+    BOOST_CHECK_EQUAL( s[9], 4004 );
+    BOOST_CHECK_CLOSE( s.getUpperBound( 9 ), 10.0, 1e-6 );
+
+    h.clear();
+    BOOST_CHECK_EQUAL( h.snapshot().total(), 0 );
+}
+
+BOOST_AUTO_TEST_CASE( log_histogram_test )
+{
+    numeric::LogHistogram h( 1e-6, 100.0, 7 );
+    BOOST_CHECK_CLOSE( h.getRelativeError(), 1.0 / 128, 1e-9 );
+
+    // every value lies within the bounds of its bucket, and the buckets
+    // have a bounded relative width
+    for( double v = 1e-6; v < 100.0; v *= 1.01 )
+    {
+	size_t idx = h.getIndex( v );
+	BOOST_CHECK( h.getLowerBound( idx ) <= v );
+	BOOST_CHECK( v < h.getUpperBound( idx ) );
+	BOOST_CHECK( (h.getUpperBound( idx ) - h.getLowerBound( idx )) / h.getLowerBound( idx )
+		<= h.getRelativeError() );
+    }
+    BOOST_CHECK_EQUAL( h.getIndex( 1.0 ) + 1, h.getIndex( 1.0 + 1.0 / 128 ) );
+    BOOST_CHECK_CLOSE( h.getUpperBound( h.getIndex( 1.0 ) ), 1.0 + 1.0 / 128, 1e-9 );
+
+    // out of range values are clamped to the edge buckets
+    BOOST_CHECK_EQUAL( h.getIndex( 0.0 ), 0 );
+    BOOST_CHECK_EQUAL( h.getIndex( -1.0 ), 0 );
+    BOOST_CHECK_EQUAL( h.getIndex( 1e-9 ), 0 );
+    BOOST_CHECK_EQUAL( h.getIndex( 1e9 ), h.size() - 1 );
+
+    BOOST_CHECK( std::isnan( h.quantile( 0.5 ) ) );
+    numeric::LogHistogram a( 1e-6, 100.0, 7 ), b( 1e-6, 100.0, 7 );
+    for( int i = 1; i <= 10000; i++ )
+    {
+	double v = i * 1e-3;
+	h.update( v );
+	(i % 2 ? a : b).update( v );
+    }
+    BOOST_CHECK_EQUAL( h.total(), 10000 );
+    BOOST_CHECK_CLOSE( h.quantile( 0.5 ), 5.0, 100.0 / 128 );
+    BOOST_CHECK_CLOSE( h.quantile( 0.99 ), 9.9, 100.0 / 128 );
+    BOOST_CHECK_CLOSE( h.quantile( 0.001 ), 0.01, 100.0 / 128 );
+
+    a.merge( b );
+    BOOST_CHECK_EQUAL( a.total(), h.total() );
+    for( size_t i = 0; i < h.size(); i++ )
+	BOOST_CHECK_EQUAL( a[i], h[i] );
+    BOOST_CHECK_THROW( a.merge( numeric::LogHistogram( 1e-3, 100.0, 7 ) ), std::invalid_argument );
+}
+
+BOOST_AUTO_TEST_CASE( histogram_nd_test )
+{
+    typedef numeric::HistogramND<3> H3;
+    H3 h( Eigen::Vector3i( 4, 5, 6 ), Eigen::Vector3d( 0, 0, 0 ), Eigen::Vector3d( 4, 5, 6 ) );
+    BOOST_CHECK_EQUAL( h.size(), 4 * 5 * 6 );
+    BOOST_CHECK_EQUAL( h.getFlatIndex( Eigen::Vector3i( 1, 2, 3 ) ), 1 * 30 + 2 * 6 + 3 );
+    BOOST_CHECK_EQUAL( h.getFlatIndex( Eigen::Vector3d( 1.5, 2.5, 3.5 ) ), 1 * 30 + 2 * 6 + 3 );
+    // clamped like Histogram
+    BOOST_CHECK_EQUAL( h.getFlatIndex( Eigen::Vector3d( -1, 2.5, 10 ) ), 0 * 30 + 2 * 6 + 5 );
+
+    // batch fill gives the same result as single updates
+    Eigen::Matrix3Xd points( 3, 1000 );
+    for( int i = 0; i < points.cols(); i++ )
+	points.col( i ) << sin( i * 0.1 ) * 3 + 2, (i % 13) * 0.5, cos( i * 0.3 ) * 4 + 3;
+    H3 single( h ), batch( h );
+    for( int i = 0; i < points.cols(); i++ )
+	single.update( Eigen::Vector3d( points.col( i ) ) );
+    batch.update( points );
+    BOOST_CHECK_EQUAL( batch.total(), 1000 );
+    BOOST_CHECK( batch.data() == single.data() );
+
+    // marginals
+    for( int axis = 0; axis < 3; axis++ )
+    {
+	numeric::HistogramND<2> m = batch.marginalize( axis );
+	BOOST_CHECK_EQUAL( m.total(), 1000 );
+	size_t sum = 0;
+	for( size_t i = 0; i < m.size(); i++ )
+	    sum += m[i];
+	BOOST_CHECK_EQUAL( sum, 1000 );
+    }
+    numeric::HistogramND<1> x = batch.marginalize( 2 ).marginalize( 1 );
+    numeric::Histogram hx( 4, 0, 4 );
+    for( int i = 0; i < points.cols(); i++ )
+	hx.update( points( 0, i ) );
+    BOOST_CHECK_EQUAL( x.axis( 0 ).count, 4 );
+    for( int i = 0; i < 4; i++ )
+	BOOST_CHECK_EQUAL( x[i], hx[i] );
+    numeric::HistogramND<2> yz = batch.marginalize( 0 );
+    BOOST_CHECK_EQUAL( yz.axis( 0 ).count, 5 );
+    BOOST_CHECK_EQUAL( yz.axis( 1 ).count, 6 );
+}
+
 BOOST_AUTO_TEST_CASE( planefitting_test )
 {
     typedef numeric::PlaneFitting<float> PF;
@@ -349,4 +1136,111 @@ BOOST_AUTO_TEST_CASE(test_join_vectors)
   BOOST_CHECK_EQUAL(true,std::equal(result.begin(),result.end(),result2.begin()));
 }
 
+BOOST_AUTO_TEST_CASE( qr_poly_fit )
+{
+    // same data as the gsl based fitPolynom test
+    float v[] = {0, 3, 2, 3, 2, 5, 4, 10, 9, 10, 9, 11, 5, 8, 6, 7, 0};
+    std::vector<float> values( v, v + sizeof(v) / sizeof(v[0]) );
+
+    std::vector<double> result;
+    double chisq = 0;
+    BOOST_CHECK( numeric::fitPolynomQR( 3, values.begin(), values.end(), result, chisq ) );
+    BOOST_CHECK_EQUAL( 3, result.size() );
+    BOOST_CHECK( result[0] > -1.28 && result[0] < -1.279 );
+    BOOST_CHECK( result[1] > 2.09 && result[1] < 2.093 );
+    BOOST_CHECK( result[2] > -0.1129 && result[2] < -0.1128 );
+    BOOST_CHECK( chisq > 0 );
+
+    // exact polynomial far from the origin, which a float design matrix can not resolve
+    std::vector<double> x, y;
+    for( int i = 0; i < 20; i++ )
+    {
+	double xi = 1000.0 + 0.5 * i;
+	x.push_back( xi );
+	y.push_back( 2.0 - 0.5 * xi + 0.25 * xi * xi );
+    }
+    numeric::QRPolyFitter fitter( 3, 4 );
+    BOOST_CHECK( fitter.fit( x.begin(), x.end(), y.begin(), result, chisq ) );
+    BOOST_CHECK_EQUAL( 20, fitter.getCapacity() );
+    BOOST_CHECK_CLOSE( result[0], 2.0, 1e-3 );
+    BOOST_CHECK_CLOSE( result[1], -0.5, 1e-6 );
+    BOOST_CHECK_CLOSE( result[2], 0.25, 1e-9 );
+    BOOST_CHECK_SMALL( chisq, 1e-12 );
+
+    // reuse on a smaller window
+    BOOST_CHECK( fitter.fit( 5, &x[3], &y[3], result, chisq ) );
+    BOOST_CHECK_EQUAL( 20, fitter.getCapacity() );
+    BOOST_CHECK_CLOSE( result[2], 0.25, 1e-6 );
+
+    BOOST_CHECK( !fitter.fit( 2, &x[0], &y[0], result, chisq ) );
+    BOOST_CHECK_THROW( numeric::QRPolyFitter( 0 ), std::invalid_argument );
+}
+
+BOOST_AUTO_TEST_CASE( polynomial_fitting )
+{
+    typedef numeric::PolynomialFitting<double, 2> PF;
+
+    // exact quadratic
+    PF pf;
+    for( int i = -5; i <= 5; i++ )
+	pf.update( i, 1.0 + 2.0 * i - 0.5 * i * i );
+    BOOST_CHECK_EQUAL( pf.n(), 11 );
+    PF::Result res = pf.solve();
+    BOOST_CHECK_CLOSE( res.getCoeffs()[0], 1.0, 1e-9 );
+    BOOST_CHECK_CLOSE( res.getCoeffs()[1], 2.0, 1e-9 );
+    BOOST_CHECK_CLOSE( res.getCoeffs()[2], -0.5, 1e-9 );
+    BOOST_CHECK_SMALL( res.getResiduals(), 1e-9 );
+
+    // moving the origin to 2 gives the polynomial in (x-2)
+    pf.shift( 2.0 );
+    BOOST_CHECK_CLOSE( pf.getCoeffs()[0], 1.0 + 4.0 - 2.0, 1e-9 );
+    BOOST_CHECK_SMALL( pf.getCoeffs()[1], 1e-9 );
+    BOOST_CHECK_CLOSE( pf.getCoeffs()[2], -0.5, 1e-9 );
+
+    // sliding window over noise on an offset, x relative to the newest
+    // sample, compared against a refit of the window. The errors must not
+    // grow with the length of the signal.
+    const int window = 32;
+    const int count = 1000000;
+    numeric::QRPolyFitter fitter( 3, window );
+    std::vector<double> x( window ), expected;
+    for( int i = 0; i < window; i++ )
+	x[i] = i - (window - 1);
+    double chisq;
+    std::vector<double> data( count );
+    for( int offset = 0; offset <= 1000; offset += 1000 )
+    {
+	srand( 42 );
+	for( int i = 0; i < count; i++ )
+	    data[i] = offset + rand() / (double)RAND_MAX;
+
+	numeric::SlidingPolynomialFit<double, 2> sliding( window );
+	for( int i = 0; i < count; i++ )
+	{
+	    sliding.update( data[i] );
+	    BOOST_REQUIRE_EQUAL( sliding.n(), std::min( i + 1, window ) );
+	    if( i < window - 1 || (i % 101 && i < count - 1) )
+		continue;
+
+	    fitter.fit( window, x.begin(), &data[i - window + 1], expected, chisq );
+	    PF::Result r = sliding.solve();
+	    BOOST_REQUIRE_SMALL( r.getCoeffs()[0] - expected[0], 1e-9 );
+	    BOOST_REQUIRE_SMALL( r.getCoeffs()[1] - expected[1], 1e-10 );
+	    BOOST_REQUIRE_SMALL( r.getCoeffs()[2] - expected[2], 1e-11 );
+	    BOOST_REQUIRE_SMALL( r.getResiduals() - chisq, 1e-6 );
+	}
+    }
+    BOOST_CHECK_THROW( (numeric::SlidingPolynomialFit<double, 2>( 2 )), std::invalid_argument );
+
+    // merge of two halves
+    PF a, b;
+    for( int i = 0; i < 10; i++ )
+	(i < 5 ? a : b).update( i, data[i] );
+    a.update( b );
+    fitter.fit( 10, x.begin() + window - 10, &data[0], expected, chisq );
+    a.shift( 9.0 );
+    for( int k = 0; k < 3; k++ )
+	BOOST_CHECK_SMALL( a.getCoeffs()[k] - expected[k], 1e-6 );
+}
+
 BOOST_AUTO_TEST_SUITE_END()
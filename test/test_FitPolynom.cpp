@@ -2,6 +2,7 @@
 #include <boost/test/included/unit_test.hpp>
 #include <numeric/FitPolynom.hpp>
 #include <iostream>
+#include <list>
 
 //test if polynomial fit is working
 BOOST_AUTO_TEST_CASE(test_poly_fit)
@@ -99,3 +100,80 @@ BOOST_AUTO_TEST_CASE(test_calc_poly_val)
   BOOST_CHECK_EQUAL(-3,numeric::calcPolyVal(values,1));
   BOOST_CHECK_EQUAL(2,numeric::calcPolyVal(values,2));
 }
+
+//test if a reused PolyFitter gives the same results as fitPolynom
+BOOST_AUTO_TEST_CASE(test_poly_fitter)
+{
+  float v[] = {0, 3, 2, 3, 2, 5, 4, 10, 9, 10, 9, 11, 5, 8, 6, 7, 0};
+  std::vector<float> values(v, v + sizeof(v) / sizeof(v[0]));
+
+  numeric::PolyFitter fitter(3, 8);
+  BOOST_CHECK_EQUAL(8, fitter.getCapacity());
+
+  std::vector<double> result, expected;
+  double chisq = 0, expected_chisq = 0;
+  BOOST_CHECK(fitter.fit(values.begin(), values.end(), result, chisq));
+  BOOST_CHECK_EQUAL(values.size(), fitter.getCapacity());
+  numeric::fitPolynom(3, values.begin(), values.end(), expected, expected_chisq);
+  BOOST_CHECK_EQUAL(3, result.size());
+  for(int i = 0; i < 3; i++)
+    BOOST_CHECK_EQUAL(expected[i], result[i]);
+  BOOST_CHECK_EQUAL(expected_chisq, chisq);
+
+  // sliding windows smaller than the workspace
+  std::vector<float> x;
+  for(int i = 0; i < 6; i++)
+    x.push_back(i);
+  for(size_t start = 0; start + 6 <= values.size(); start++)
+  {
+    BOOST_CHECK(fitter.fit(6, &x[0], &values[start], result, chisq));
+    numeric::fitPolynom(3, x.begin(), x.end(), values.begin() + start, values.begin() + start + 6, expected, expected_chisq);
+    for(int i = 0; i < 3; i++)
+      BOOST_CHECK_CLOSE(expected[i], result[i], 1e-9);
+    BOOST_CHECK_CLOSE(expected_chisq + 1, chisq + 1, 1e-9);
+  }
+  BOOST_CHECK_EQUAL(values.size(), fitter.getCapacity());
+
+  BOOST_CHECK_THROW(numeric::PolyFitter(0), std::invalid_argument);
+}
+
+//test if the design matrix keeps double precision
+BOOST_AUTO_TEST_CASE(test_poly_fit_precision)
+{
+  // x is not representable as float, rounding it to float gives relative
+  // errors of 3e-6 to 5e-5 in the coefficients, double about 1e-13
+  std::vector<double> x, y;
+  for(int i = 0; i < 20; i++)
+  {
+    double xi = 10.1 + 0.1 * i;
+    x.push_back(xi);
+    y.push_back(2.0 - 0.5 * xi + 0.25 * xi * xi);
+  }
+  std::vector<double> result;
+  double chisq = 0;
+  BOOST_CHECK(numeric::fitPolynom(3, x.begin(), x.end(), y.begin(), y.end(), result, chisq));
+  BOOST_CHECK_CLOSE(result[0], 2.0, 1e-8);
+  BOOST_CHECK_CLOSE(result[1], -0.5, 1e-8);
+  BOOST_CHECK_CLOSE(result[2], 0.25, 1e-8);
+}
+
+//test that a list, which is not random access, gives the same result
+BOOST_AUTO_TEST_CASE(test_poly_fit_list)
+{
+  float v[] = {0, 3, 2, 3, 2, 5, 4, 10, 9, 10, 9, 11, 5, 8, 6, 7, 0};
+  std::vector<float> values(v, v + sizeof(v) / sizeof(v[0]));
+  std::list<float> list(values.begin(), values.end());
+
+  std::vector<double> expected, result;
+  double expected_chisq = 0, chisq = 0;
+  numeric::fitPolynom(3, values.begin(), values.end(), expected, expected_chisq);
+  BOOST_CHECK(numeric::fitPolynom(3, list.begin(), list.end(), result, chisq));
+  BOOST_CHECK_EQUAL(3, result.size());
+  for(int i = 0; i < 3; i++)
+    BOOST_CHECK_EQUAL(expected[i], result[i]);
+
+  // an underdetermined fit is refused
+  numeric::PolyFitter fitter(3);
+  BOOST_CHECK(!fitter.fit(2, values.begin(), result, chisq));
+  BOOST_CHECK(result.empty());
+}
@@ -1,6 +1,10 @@
 #include <boost/test/unit_test.hpp>
 #include <numeric/SavitzkyGolayFilter.hpp>
+#include <numeric/SavitzkyGolaySmoother.hpp>
+#include <numeric/SavitzkyGolayCache.hpp>
+#include <numeric/SavitzkyGolayKernel.hpp>
 #include <iostream>
+#include <thread>
 
 BOOST_AUTO_TEST_SUITE(savitzky_golay)
 
@@ -278,4 +282,183 @@ BOOST_AUTO_TEST_CASE(savgol_9pt_3stderivative_sextic)
         BOOST_CHECK_CLOSE(coeff[i+half_width], values[i+half_width], 0.0001);
 }
 
+BOOST_AUTO_TEST_CASE(savgol_high_order)
+{
+    // polynomials up to the filter order are reproduced, and their
+    // derivatives, at every least-squares point
+    const int half_width = 8;
+    const int polynom_order = 10;
+    std::vector<double> coeff;
+    for (int s = 0; s <= 2; s++)
+        for (int t = -half_width; t <= half_width; t++)
+        {
+            numeric::SavitzkyGolayFilter(coeff, t, half_width, polynom_order, s);
+            double sum = 0;
+            for (int i = -half_width; i <= half_width; i++)
+                sum += coeff[i+half_width] * pow(i / 8.0, 10);
+            // s'th derivative of (i/8)^10
+            double factor = 1;
+            for (int d = 0; d < s; d++)
+                factor *= (10 - d) / 8.0;
+            double expected = factor * pow(t / 8.0, 10 - s);
+            BOOST_CHECK_SMALL(sum - expected, 1e-6);
+        }
+}
+
+BOOST_AUTO_TEST_CASE(savgol_smoother_polynomial)
+{
+    // a quadratic is reproduced exactly, including the edges
+    const size_t count = 40;
+    const double step = 0.1;
+    std::vector<double> signal, derivative;
+    for (size_t k = 0; k < count; k++)
+    {
+        double x = k * step;
+        signal.push_back(2.0 - x + 0.5 * x * x);
+        derivative.push_back(-1.0 + x);
+    }
+
+    numeric::SavitzkyGolaySmoother smoother(3, 2);
+    numeric::SavitzkyGolaySmoother differentiator(3, 2, 1, step);
+    BOOST_CHECK_EQUAL(smoother.windowSize(), 7);
+    BOOST_CHECK_EQUAL(smoother.delay(), 3);
+
+    std::vector<double> out(count);
+    smoother.apply(&signal[0], count, &out[0]);
+    for (size_t k = 0; k < count; k++)
+        BOOST_CHECK_CLOSE(out[k], signal[k], 1e-9);
+    differentiator.apply(&signal[0], count, &out[0]);
+    for (size_t k = 0; k < count; k++)
+        BOOST_CHECK_SMALL(out[k] - derivative[k], 1e-9);
+
+    // the kernels are the ones of SavitzkyGolayFilter
+    std::vector<double> coeff;
+    numeric::SavitzkyGolayFilter(coeff, -2, 3, 2, 1, step);
+    for (int i = 0; i < 7; i++)
+        BOOST_CHECK_EQUAL(differentiator.kernel(-2)[i], coeff[i]);
+
+    BOOST_CHECK_THROW(smoother.apply(&signal[0], 6, &out[0]), std::invalid_argument);
+    BOOST_CHECK_THROW(numeric::SavitzkyGolaySmoother(2, 5), std::invalid_argument);
+}
+
+BOOST_AUTO_TEST_CASE(savgol_smoother_streaming)
+{
+    const size_t count = 100;
+    std::vector<double> signal;
+    for (size_t k = 0; k < count; k++)
+        signal.push_back(sin(0.1 * k) + ((k * 7919) % 13) / 13.0);
+
+    numeric::SavitzkyGolaySmoother smoother(4, 3);
+    std::vector<double> expected(count);
+    smoother.apply(&signal[0], count, &expected[0]);
+
+    // per sample
+    std::vector<double> out(smoother.maxOutputs(count));
+    std::vector<double> buffer(smoother.delay() + 1);
+    size_t n = 0;
+    for (size_t k = 0; k < count; k++)
+    {
+        size_t written = smoother.update(signal[k], &buffer[0]);
+        BOOST_CHECK_EQUAL(written, k < 8 ? 0 : (k == 8 ? 5 : 1));
+        for (size_t i = 0; i < written; i++)
+            out[n++] = buffer[i];
+    }
+    n += smoother.flush(&out[n]);
+    BOOST_REQUIRE_EQUAL(n, count);
+    for (size_t k = 0; k < count; k++)
+        BOOST_CHECK_CLOSE(out[k] + 10, expected[k] + 10, 1e-10);
+
+    // in blocks of different sizes
+    n = smoother.process(&signal[0], 3, &out[0]);
+    n += smoother.process(&signal[3], 50, &out[n]);
+    n += smoother.process(&signal[53], count - 53, &out[n]);
+    n += smoother.flush(&out[n]);
+    BOOST_REQUIRE_EQUAL(n, count);
+    for (size_t k = 0; k < count; k++)
+        BOOST_CHECK_CLOSE(out[k] + 10, expected[k] + 10, 1e-10);
+
+    // too short streams give no output
+    smoother.process(&signal[0], 5, &out[0]);
+    BOOST_CHECK_EQUAL(smoother.flush(&out[0]), 0);
+}
+
+BOOST_AUTO_TEST_CASE(savgol_cache)
+{
+    std::vector<double> coeff;
+    numeric::SavitzkyGolayFilter(coeff, 1, 5, 3, 1);
+    numeric::SavitzkyGolayCoefficients c = numeric::SavitzkyGolayCache::get(1, 5, 3, 1);
+    BOOST_REQUIRE_EQUAL(c.size(), coeff.size());
+    for (size_t i = 0; i < coeff.size(); i++)
+        BOOST_CHECK_EQUAL(c[i], coeff[i]);
+
+    // the same design gives the same memory
+    size_t size = numeric::SavitzkyGolayCache::size();
+    BOOST_CHECK(numeric::SavitzkyGolayCache::get(1, 5, 3, 1).data() == c.data());
+    BOOST_CHECK_EQUAL(numeric::SavitzkyGolayCache::size(), size);
+
+    // differentiators for varying steps share the cached design
+    for (int i = 1; i <= 10; i++)
+        numeric::SavitzkyGolaySmoother(5, 3, 1, 0.001 * i);
+    BOOST_CHECK_EQUAL(numeric::SavitzkyGolayCache::size(), size + 10);
+    numeric::SavitzkyGolaySmoother(5, 3, 1, 0.5);
+    BOOST_CHECK_EQUAL(numeric::SavitzkyGolayCache::size(), size + 10);
+    BOOST_CHECK_THROW(numeric::SavitzkyGolaySmoother(5, 3, 1, 0.0), std::invalid_argument);
+
+    BOOST_CHECK_THROW(numeric::SavitzkyGolayCache::get(6, 5, 3), std::invalid_argument);
+
+    // concurrent lookups and inserts, enough designs to grow the table
+    std::vector<std::thread> threads;
+    std::vector<int> mismatches(4, 0);
+    for (int w = 0; w < 4; w++)
+        threads.push_back(std::thread([w, &mismatches]()
+        {
+            for (int m = 1; m <= 20; m++)
+                for (int t = -m; t <= m; t++)
+                {
+                    numeric::SavitzkyGolayCoefficients a = numeric::SavitzkyGolayCache::get(t, m, 2);
+                    numeric::SavitzkyGolayCoefficients b = numeric::SavitzkyGolayCache::get(t, m, 2);
+                    if (a.data() != b.data() || a.size() != size_t(2*m+1))
+                        mismatches[w]++;
+                }
+        }));
+    for (size_t i = 0; i < threads.size(); i++)
+        threads[i].join();
+    for (size_t i = 0; i < mismatches.size(); i++)
+        BOOST_CHECK_EQUAL(mismatches[i], 0);
+    // 440 designs, some of which were cached before, no duplicates
+    BOOST_CHECK_GT(numeric::SavitzkyGolayCache::size(), size + 10 + 400);
+    BOOST_CHECK_LE(numeric::SavitzkyGolayCache::size(), size + 10 + 440);
+
+    std::vector<double> reference;
+    numeric::SavitzkyGolayFilter(reference, -7, 12, 2);
+    numeric::SavitzkyGolayCoefficients cached = numeric::SavitzkyGolayCache::get(-7, 12, 2);
+    BOOST_CHECK(std::equal(cached.begin(), cached.end(), reference.begin()));
+}
+
+BOOST_AUTO_TEST_CASE(savgol_constexpr_kernel)
+{
+    // evaluated by the compiler
+    constexpr std::array<double, 7> smooth = numeric::savitzkyGolayKernel<3, 2>();
+    constexpr std::array<double, 7> edge = numeric::savitzkyGolayKernel<3, 2, 1>(-3, 0.01);
+    constexpr std::array<double, 9> sextic = numeric::savitzkyGolayKernel<4, 6, 3>();
+
+    std::vector<double> coeff;
+    numeric::SavitzkyGolayFilter(coeff, 0, 3, 2);
+    for (int i = 0; i < 7; i++)
+        BOOST_CHECK_EQUAL(smooth[i], coeff[i]);
+    numeric::SavitzkyGolayFilter(coeff, -3, 3, 2, 1, 0.01);
+    for (int i = 0; i < 7; i++)
+        BOOST_CHECK_EQUAL(edge[i], coeff[i]);
+    numeric::SavitzkyGolayFilter(coeff, 0, 4, 6, 3);
+    for (int i = 0; i < 9; i++)
+        BOOST_CHECK_EQUAL(sextic[i], coeff[i]);
+
+    // 7 pt quadratic smoothing, -2 3 6 7 6 3 -2 / 21
+    std::vector<double> data(7, 0.0);
+    data[3] = 21;
+    BOOST_CHECK_CLOSE(numeric::applyKernel(smooth, &data[0]), 7.0, 1e-9);
+
+    BOOST_CHECK_THROW((numeric::savitzkyGolayKernel<3, 2>(4)), std::invalid_argument);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -1,7 +1,9 @@
 #define BOOST_TEST_MODULE DiscreteFilt
 #include <boost/test/included/unit_test.hpp>
 #include <numeric/DiscreteFilter.hpp>
+#include <numeric/SosFilter.hpp>
 #include <iostream>
+#include <algorithm>
 
 BOOST_AUTO_TEST_CASE( filter_test )
 {
@@ -67,3 +69,309 @@ BOOST_AUTO_TEST_CASE( filter_test )
 //	std::cout << "\n\n uniSamplingTime " << uniSamplingTime << std::endl;
 //	std::cout << "\n uniFilterElements " << uniFilterElements << std::endl;
 }
+
+BOOST_AUTO_TEST_CASE( filter_reference_test )
+{
+	// compares against the difference equation evaluated as in the original
+	// per-sample implementation, the outputs have to be bit identical
+	const int numChannels = 7;
+	const double samplingTime = 0.01;
+	const double pole1 = -20, pole2 = -35;
+
+	numeric::DiscreteFilter uniFilter(samplingTime, 1);
+	numeric::DiscreteFilter multiFilter(samplingTime, numChannels);
+	BOOST_CHECK(uniFilter.setPoles(pole1, pole2));
+	BOOST_CHECK(multiFilter.setPoles(pole1, pole2));
+
+	double ep1T = exp(pole1*samplingTime);
+	double ep2T = exp(pole2*samplingTime);
+	base::MatrixXd past = base::MatrixXd::Zero(numChannels, 2);
+
+	base::VectorXd input(numChannels);
+	base::VectorXd output(numChannels);
+	for (int k = 0; k < 200; k++)
+	{
+		for (int i = 0; i < numChannels; i++)
+			input[i] = sin(0.1*k*(i+1)) + (k % 13 == 0 ? 1.0 : 0.0);
+
+		BOOST_REQUIRE(multiFilter.calcOutput(output, input));
+		double uniInput = input[0];
+		double uniOutput;
+		BOOST_REQUIRE(uniFilter.calcOutput(uniOutput, uniInput));
+
+		for (int i = 0; i < numChannels; i++)
+		{
+			double expected = (1 - (ep1T + ep2T) + ep1T*ep2T)*input[i] +
+							  (ep1T + ep2T)*past(i,1) - ep1T*ep2T*past(i,0);
+			BOOST_CHECK_EQUAL(output[i], expected);
+			past(i,0) = past(i,1);
+			past(i,1) = expected;
+		}
+		BOOST_CHECK_EQUAL(uniOutput, output[0]);
+	}
+
+	// wrong number of elements is rejected
+	base::VectorXd wrongInput = base::VectorXd::Zero(3);
+	BOOST_CHECK(!multiFilter.calcOutput(output, wrongInput));
+
+	multiFilter.resetFilter();
+	input.setZero();
+	BOOST_CHECK(multiFilter.calcOutput(output, input));
+	BOOST_CHECK(output.isZero());
+}
+
+BOOST_AUTO_TEST_CASE( filter_block_test )
+{
+	const int numChannels = 5;
+	const int numSamples = 300;
+
+	numeric::DiscreteFilter sampleFilter(0.01, numChannels);
+	numeric::DiscreteFilter blockFilter(0.01, numChannels);
+	numeric::DiscreteFilter uniSampleFilter(0.01, 1);
+	numeric::DiscreteFilter uniBlockFilter(0.01, 1);
+	sampleFilter.setPoles(-10, -15);
+	blockFilter.setPoles(-10, -15);
+	uniSampleFilter.setPoles(-10, -15);
+	uniBlockFilter.setPoles(-10, -15);
+
+	base::MatrixXd input(numChannels, numSamples);
+	for (int k = 0; k < numSamples; k++)
+		for (int i = 0; i < numChannels; i++)
+			input(i,k) = cos(0.05*k*(i+1)) + i;
+
+	base::MatrixXd expected(numChannels, numSamples);
+	for (int k = 0; k < numSamples; k++)
+	{
+		base::VectorXd in = input.col(k);
+		base::VectorXd out(numChannels);
+		sampleFilter.calcOutput(out, in);
+		expected.col(k) = out;
+	}
+
+	// split into two blocks to check that the state carries over
+	base::MatrixXd first = input.leftCols(100);
+	base::MatrixXd second;
+	BOOST_CHECK(blockFilter.process(first));
+	BOOST_CHECK(blockFilter.process(input.rightCols(numSamples - 100), second));
+	BOOST_CHECK(first == expected.leftCols(100));
+	BOOST_CHECK(second == expected.rightCols(numSamples - 100));
+
+	// univariable, in place
+	std::vector<double> buffer(numSamples);
+	for (int k = 0; k < numSamples; k++)
+		buffer[k] = input(2,k);
+	BOOST_CHECK(uniBlockFilter.process(&buffer[0], &buffer[0], 150));
+	BOOST_CHECK(uniBlockFilter.process(&buffer[150], &buffer[150], numSamples - 150));
+	for (int k = 0; k < numSamples; k++)
+	{
+		double in = input(2,k);
+		double out;
+		uniSampleFilter.calcOutput(out, in);
+		BOOST_CHECK_EQUAL(buffer[k], out);
+	}
+
+	// the univariable block API needs a filter with one element
+	BOOST_CHECK(!blockFilter.process(&buffer[0], &buffer[0], numSamples));
+	base::MatrixXd wrong = base::MatrixXd::Zero(2, 10);
+	BOOST_CHECK(!blockFilter.process(wrong));
+}
+
+BOOST_AUTO_TEST_CASE( sos_design_test )
+{
+	const double T = 0.001;
+	const double halfPower = sqrt(0.5);
+
+	// scipy.signal.butter(2, 0.2)
+	std::vector<numeric::Biquad> lp2 = numeric::butterworthLowPass(2, 100, T);
+	BOOST_REQUIRE_EQUAL(lp2.size(), 1);
+	BOOST_CHECK_CLOSE(lp2[0].b0, 0.06745527388907, 1e-9);
+	BOOST_CHECK_CLOSE(lp2[0].b1, 0.13491054777814, 1e-9);
+	BOOST_CHECK_CLOSE(lp2[0].b2, 0.06745527388907, 1e-9);
+	BOOST_CHECK_CLOSE(lp2[0].a1, -1.14298050253990, 1e-9);
+	BOOST_CHECK_CLOSE(lp2[0].a2, 0.41280159809619, 1e-9);
+
+	std::vector<numeric::Biquad> lp5 = numeric::butterworthLowPass(5, 10, T);
+	BOOST_CHECK_EQUAL(lp5.size(), 3);
+	BOOST_CHECK_CLOSE(std::abs(numeric::frequencyResponse(lp5, 0, T)), 1.0, 1e-9);
+	BOOST_CHECK_CLOSE(std::abs(numeric::frequencyResponse(lp5, 10, T)), halfPower, 1e-9);
+	BOOST_CHECK_LT(std::abs(numeric::frequencyResponse(lp5, 100, T)), 1e-4);
+
+	std::vector<numeric::Biquad> hp3 = numeric::butterworthHighPass(3, 50, T);
+	BOOST_CHECK_EQUAL(hp3.size(), 2);
+	BOOST_CHECK_CLOSE(std::abs(numeric::frequencyResponse(hp3, 500, T)), 1.0, 1e-9);
+	BOOST_CHECK_CLOSE(std::abs(numeric::frequencyResponse(hp3, 50, T)), halfPower, 1e-9);
+	BOOST_CHECK_SMALL(std::abs(numeric::frequencyResponse(hp3, 0, T)), 1e-12);
+
+	std::vector<numeric::Biquad> bp3 = numeric::butterworthBandPass(3, 20, 80, T);
+	BOOST_CHECK_EQUAL(bp3.size(), 3);
+	BOOST_CHECK_CLOSE(std::abs(numeric::frequencyResponse(bp3, 20, T)), halfPower, 1e-9);
+	BOOST_CHECK_CLOSE(std::abs(numeric::frequencyResponse(bp3, 80, T)), halfPower, 1e-9);
+	BOOST_CHECK_SMALL(std::abs(numeric::frequencyResponse(bp3, 0, T)), 1e-12);
+	BOOST_CHECK_SMALL(std::abs(numeric::frequencyResponse(bp3, 500, T)), 1e-12);
+
+	// the pass band edge is at -ripple dB, even orders start at the bottom
+	// of the ripple
+	const double rippleGain = pow(10.0, -1.0 / 20);
+	std::vector<numeric::Biquad> cheb4 = numeric::chebyshevLowPass(4, 1.0, 30, T);
+	BOOST_CHECK_CLOSE(std::abs(numeric::frequencyResponse(cheb4, 0, T)), rippleGain, 1e-9);
+	BOOST_CHECK_CLOSE(std::abs(numeric::frequencyResponse(cheb4, 30, T)), rippleGain, 1e-9);
+	for (double f = 0; f < 30; f += 0.5)
+		BOOST_CHECK_LE(std::abs(numeric::frequencyResponse(cheb4, f, T)), 1.0 + 1e-9);
+	std::vector<numeric::Biquad> cheb3 = numeric::chebyshevHighPass(3, 1.0, 30, T);
+	BOOST_CHECK_CLOSE(std::abs(numeric::frequencyResponse(cheb3, 500, T)), 1.0, 1e-9);
+	BOOST_CHECK_CLOSE(std::abs(numeric::frequencyResponse(cheb3, 30, T)), rippleGain, 1e-9);
+	std::vector<numeric::Biquad> chebBp = numeric::chebyshevBandPass(2, 1.0, 40, 60, T);
+	BOOST_CHECK_CLOSE(std::abs(numeric::frequencyResponse(chebBp, 40, T)), rippleGain, 1e-9);
+	BOOST_CHECK_CLOSE(std::abs(numeric::frequencyResponse(chebBp, 60, T)), rippleGain, 1e-9);
+
+	BOOST_CHECK_THROW(numeric::butterworthLowPass(0, 10, T), std::invalid_argument);
+	BOOST_CHECK_THROW(numeric::butterworthLowPass(2, 600, T), std::invalid_argument);
+	BOOST_CHECK_THROW(numeric::butterworthBandPass(2, 80, 20, T), std::invalid_argument);
+	BOOST_CHECK_THROW(numeric::chebyshevLowPass(2, 0.0, 10, T), std::invalid_argument);
+}
+
+BOOST_AUTO_TEST_CASE( sos_filter_test )
+{
+	const double T = 0.01;
+	const int numChannels = 3;
+	const int numSamples = 200;
+
+	// the matched pole-zero design gives the same filter as DiscreteFilter
+	numeric::DiscreteFilter discrete(T, 1);
+	discrete.setPoles(-5, -8);
+	numeric::SosFilter matched(numeric::matchedPoleZeroLowPass(-5, -8, T));
+	for (int k = 0; k < numSamples; k++)
+	{
+		double in = sin(0.2*k), out;
+		discrete.calcOutput(out, in);
+		BOOST_CHECK_CLOSE(matched.process(in) + 10, out + 10, 1e-10);
+	}
+
+	std::vector<numeric::Biquad> sections = numeric::butterworthBandPass(3, 2, 10, T);
+	numeric::SosFilter single(sections);
+	numeric::SosFilter block(sections);
+	numeric::SosFilter multi(sections, numChannels);
+
+	base::MatrixXd input(numChannels, numSamples);
+	for (int k = 0; k < numSamples; k++)
+		for (int i = 0; i < numChannels; i++)
+			input(i,k) = (k == 10 ? 1.0 : 0.0) + cos(0.3*k*(i+1));
+
+	base::MatrixXd output;
+	multi.process(input.leftCols(50), output);
+	base::MatrixXd rest = input.rightCols(numSamples - 50);
+	multi.process(rest);
+
+	std::vector<double> buffer(numSamples);
+	for (int k = 0; k < numSamples; k++)
+		buffer[k] = input(1,k);
+	block.process(&buffer[0], &buffer[0], 120);
+	block.process(&buffer[120], &buffer[120], numSamples - 120);
+
+	for (int k = 0; k < numSamples; k++)
+	{
+		double expected = single.process(input(1,k));
+		BOOST_CHECK_CLOSE(buffer[k] + 10, expected + 10, 1e-10);
+		BOOST_CHECK_CLOSE((k < 50 ? output(1,k) : rest(1,k-50)) + 10, expected + 10, 1e-10);
+	}
+
+	// starting in steady state there is no transient
+	numeric::SosFilter lowPass(numeric::chebyshevLowPass(3, 0.5, 5, T), numChannels);
+	base::VectorXd level(numChannels);
+	level << 1.0, -2.0, 3.5;
+	lowPass.setSteadyState(level);
+	base::MatrixXd constant = level * base::MatrixXd::Ones(1, 20);
+	lowPass.process(constant);
+	for (int k = 0; k < 20; k++)
+		BOOST_CHECK(constant.col(k).isApprox(level, 1e-12));
+	lowPass.reset();
+	constant = level * base::MatrixXd::Ones(1, 20);
+	lowPass.process(constant);
+	BOOST_CHECK(!constant.col(0).isApprox(level, 1e-3));
+
+	BOOST_CHECK_THROW(numeric::SosFilter(std::vector<numeric::Biquad>()), std::invalid_argument);
+	BOOST_CHECK_THROW(multi.process(&buffer[0], &buffer[0], 10), std::invalid_argument);
+	base::MatrixXd wrong(2, 5);
+	BOOST_CHECK_THROW(multi.process(wrong), std::invalid_argument);
+}
+
+BOOST_AUTO_TEST_CASE( filtfilt_test )
+{
+	const double T = 0.01;
+	const int numChannels = 2;
+	const int numSamples = 150;
+	std::vector<numeric::Biquad> sections = numeric::butterworthLowPass(3, 4, T);
+	const int pad = 3 * (2 * sections.size() + 1);
+
+	base::MatrixXd signal(numChannels, numSamples);
+	for (int k = 0; k < numSamples; k++)
+	{
+		signal(0,k) = sin(2*M_PI*1.0*k*T) + 0.3*sin(2*M_PI*30.0*k*T) + 2.0;
+		signal(1,k) = k*T + 0.2*cos(2*M_PI*25.0*k*T);
+	}
+
+	// reference: explicit odd extension, forward pass, reversal, backward
+	// pass on copies of the data
+	base::MatrixXd expected(numChannels, numSamples);
+	for (int i = 0; i < numChannels; i++)
+	{
+		std::vector<double> ext;
+		for (int j = pad; j > 0; j--)
+			ext.push_back(2*signal(i,0) - signal(i,j));
+		for (int k = 0; k < numSamples; k++)
+			ext.push_back(signal(i,k));
+		for (int j = 1; j <= pad; j++)
+			ext.push_back(2*signal(i,numSamples-1) - signal(i,numSamples-1-j));
+
+		numeric::SosFilter forward(sections);
+		forward.setSteadyState(base::VectorXd::Constant(1, ext.front()));
+		forward.process(&ext[0], &ext[0], ext.size());
+		std::reverse(ext.begin(), ext.end());
+		numeric::SosFilter backward(sections);
+		backward.setSteadyState(base::VectorXd::Constant(1, ext.front()));
+		backward.process(&ext[0], &ext[0], ext.size());
+		std::reverse(ext.begin(), ext.end());
+		for (int k = 0; k < numSamples; k++)
+			expected(i,k) = ext[pad + k];
+	}
+
+	numeric::SosFilter filter(sections, numChannels);
+	base::MatrixXd filtered = signal;
+	filter.filtfilt(filtered);
+	for (int i = 0; i < numChannels; i++)
+		for (int k = 0; k < numSamples; k++)
+			BOOST_CHECK_CLOSE(filtered(i,k) + 10, expected(i,k) + 10, 1e-9);
+
+	// zero phase: the slow component passes without delay
+	for (int k = 40; k < numSamples - 40; k++)
+		BOOST_CHECK_SMALL(filtered(0,k) - sin(2*M_PI*1.0*k*T) - 2.0, 0.02);
+
+	// the state is reset afterwards
+	base::MatrixXd zero = base::MatrixXd::Zero(numChannels, 5);
+	filter.process(zero);
+	BOOST_CHECK(zero.isZero());
+
+	// a constant signal has no edge transients
+	std::vector<double> constant(20, 3.0);
+	numeric::SosFilter single(sections);
+	single.filtfilt(&constant[0], constant.size());
+	for (size_t k = 0; k < constant.size(); k++)
+		BOOST_CHECK_CLOSE(constant[k], 3.0, 1e-9);
+
+	// DiscreteFilter uses the same engine with its matched pole-zero design
+	numeric::DiscreteFilter discrete(T, numChannels);
+	discrete.setPoles(-20, -30);
+	numeric::SosFilter matched(numeric::matchedPoleZeroLowPass(-20, -30, T), numChannels);
+	base::MatrixXd a = signal, b = signal;
+	BOOST_CHECK(discrete.filtfilt(a));
+	matched.filtfilt(b);
+	BOOST_CHECK(a == b);
+	base::MatrixXd wrong(3, 10);
+	BOOST_CHECK(!discrete.filtfilt(wrong));
+
+	// short signals limit the padding
+	std::vector<double> shortSignal(3);
+	shortSignal[0] = 1; shortSignal[1] = 2; shortSignal[2] = 4;
+	single.filtfilt(&shortSignal[0], shortSignal.size());
+	BOOST_CHECK(std::isfinite(shortSignal[0]) && std::isfinite(shortSignal[2]));
+}